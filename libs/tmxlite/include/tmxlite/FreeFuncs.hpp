@@ -66,6 +66,30 @@ namespace tmx
     //using inline here just to supress unused warnings on gcc
     bool decompress(const char* source, std::vector<unsigned char>& dest, std::size_t inSize, std::size_t expectedSize);
 
+    /*!
+    \brief Inflates zlib (or gzip with USE_EXTLIBS) data straight into a preallocated buffer.
+    Doesn't log so it can be called from worker threads.
+    \returns The number of bytes written, or 0 if the data is invalid or larger than destSize
+    */
+    std::size_t decompress(const char* source, std::size_t inSize, unsigned char* dest, std::size_t destSize);
+
+    /*!
+    \brief Decodes base64 text straight into a preallocated buffer.
+    Whitespace is skipped and decoding stops at the first padding character.
+    Blocks of 16 characters are decoded with SSSE3 when the CPU supports it.
+    Doesn't log so it can be called from worker threads.
+    \returns The number of bytes written, or 0 if the text is invalid or decodes to more than destSize
+    */
+    std::size_t base64_decode(const char* source, std::size_t inSize, unsigned char* dest, std::size_t destSize);
+
+    /*!
+    \brief Returns the largest number of bytes inSize characters of base64 text can decode to
+    */
+    static inline std::size_t base64_decodedSize(std::size_t inSize)
+    {
+        return (inSize / 4u) * 3u + 2u;
+    }
+
     static inline std::string base64_decode(std::string const& encoded_string)
     {
         static const std::string base64_chars =
@@ -40,6 +40,8 @@ source distribution.
 
 namespace tmx
 {
+    class TileLayer;
+
     /*!
     \brief Holds the xml version of the loaded map
     */
@@ -109,6 +111,21 @@ namespace tmx
         */
         bool load(const std::string&);
 
+        /*!
+        \brief Sets whether load() maps the files into memory, the default,
+        or reads them into an owned buffer.
+        Reading is slower but safe against a file rewritten while it is
+        parsed, eg when reloading a file an editor is still saving: a
+        mapped file truncated mid parse kills the process with SIGBUS.
+        Also applies to the tile sets and templates the map loads.
+        */
+        void setFileMapping(bool enabled) { m_fileMapping = enabled; }
+
+        /*!
+        \brief Returns true if load() maps the files into memory
+        */
+        bool getFileMapping() const { return m_fileMapping; }
+
         /*!
         \brief Loads a map from a document stored in a string
         \param data A std::string containing the map data to load
@@ -251,6 +268,7 @@ namespace tmx
         Orientation m_orientation;
         RenderOrder m_renderOrder;
         bool m_infinite;
+        bool m_fileMapping;
 
         Vector2u m_tileCount;
         Vector2u m_tileSize;
@@ -275,6 +293,10 @@ namespace tmx
 
         bool parseMapNode(const pugi::xml_node&);
 
+        //decodes the base64 data of every tile layer in parallel
+        void decodeTileLayers();
+        static void collectTileLayers(const std::vector<Layer::Ptr>&, std::vector<TileLayer*>&);
+
         //always returns false so we can return this
         //on load failure
         bool reset();
@@ -89,9 +89,34 @@ namespace tmx
         const std::vector<Chunk>& getChunks() const { return m_chunks; }
 
     private:
+        friend class Map;
+
+        /*!
+        \brief base64 layer or chunk data waiting to be decoded.
+        When parsed by a Map the text still points into the xml document
+        and the map decodes the data of all its layers in parallel.
+        */
+        struct PendingData final
+        {
+            const char* text = nullptr;
+            std::size_t textLength = 0;
+            std::int32_t compression = 0;
+            std::size_t tileCount = 0;
+            std::int32_t chunkIndex = -1; //!< -1 for the layer tiles
+            std::vector<std::uint32_t> IDs; //!< preallocated GID buffer, filled by decode()
+            std::string error;
+        };
+
         std::vector<Tile> m_tiles;
         std::vector<Chunk> m_chunks;
         std::size_t m_tileCount;
+        std::vector<PendingData> m_pendingData;
+
+        //thread safe, touches nothing but the given data
+        static void decode(PendingData&);
+
+        //creates the tiles from the decoded data, must be called on the loading thread
+        void applyPendingData();
 
         void parseBase64(const pugi::xml_node&);
         void parseCSV(const pugi::xml_node&);
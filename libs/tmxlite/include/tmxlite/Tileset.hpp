@@ -137,6 +137,13 @@ namespace tmx
         */
         void parse(pugi::xml_node, Map*);
 
+        /*!
+        \brief Releases the cached tsx files.
+        External tile sets are parsed once and shared by every map
+        which references them, until the file changes or this is called.
+        */
+        static void clearCache();
+
         /*!
         \brief Returns the first GID of this tile set.
         This the ID of the first tile in the tile set, so that
@@ -286,6 +293,8 @@ namespace tmx
 
         void reset();
 
+        void setFirstGID(std::uint32_t);
+
         void parseOffsetNode(const pugi::xml_node&);
         void parsePropertyNode(const pugi::xml_node&);
         void parseTerrainNode(const pugi::xml_node&);
@@ -36,6 +36,240 @@ source distribution.
 
 #include <cstring>
 
+//SSSE3 base64 decoding, either enabled by the compiler flags
+//or compiled for the ssse3 target and selected at run time
+#if defined(__SSSE3__) || defined(__AVX__)
+#define TMX_BASE64_SSSE3
+#define TMX_SSSE3_TARGET
+#include <tmmintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TMX_BASE64_SSSE3
+#define TMX_SSSE3_RUNTIME
+#define TMX_SSSE3_TARGET __attribute__((target("ssse3")))
+#include <tmmintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define TMX_BASE64_SSSE3
+#define TMX_SSSE3_RUNTIME
+#define TMX_SSSE3_TARGET
+#include <intrin.h>
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+    enum Base64Value : unsigned char
+    {
+        Whitespace = 64,
+        Padding = 65,
+        Invalid = 255
+    };
+
+    //maps a character to its 6 bit value or one of Base64Value
+    struct Base64Table final
+    {
+        unsigned char values[256];
+
+        Base64Table()
+        {
+            static const char chars[] =
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                "abcdefghijklmnopqrstuvwxyz"
+                "0123456789+/";
+
+            std::memset(values, Invalid, sizeof(values));
+            for (auto i = 0u; i < 64u; ++i)
+            {
+                values[static_cast<unsigned char>(chars[i])] = static_cast<unsigned char>(i);
+            }
+            values[static_cast<unsigned char>(' ')] = Whitespace;
+            values[static_cast<unsigned char>('\t')] = Whitespace;
+            values[static_cast<unsigned char>('\r')] = Whitespace;
+            values[static_cast<unsigned char>('\n')] = Whitespace;
+            values[static_cast<unsigned char>('=')] = Padding;
+        }
+    };
+
+#ifdef TMX_BASE64_SSSE3
+    bool hasSSSE3()
+    {
+#if defined(TMX_SSSE3_RUNTIME) && defined(_MSC_VER)
+        static const bool supported = []()
+        {
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+        }();
+        return supported;
+#elif defined(TMX_SSSE3_RUNTIME)
+        static const bool supported = __builtin_cpu_supports("ssse3") != 0;
+        return supported;
+#else
+        return true;
+#endif
+    }
+
+    //decodes blocks of 16 characters into 12 bytes until a block contains
+    //something other than base64 characters, then the scalar loop takes over.
+    //Each store writes 16 bytes so 16 bytes of output space are required.
+    TMX_SSSE3_TARGET bool decodeBlocks(const unsigned char*& src, const unsigned char* end, unsigned char*& out, const unsigned char* outEnd)
+    {
+        //the nibble lookup tables validate and translate the characters
+        //without branches, see Wojciech Mula's base64 decoding articles
+        const __m128i lutLo = _mm_setr_epi8(
+            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+            0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i lutHi = _mm_setr_epi8(
+            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i lutRoll = _mm_setr_epi8(
+            0, 16, 19, 4, -65, -65, -71, -71,
+            0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i mask2F = _mm_set1_epi8(0x2F);
+        const __m128i packPairs = _mm_set1_epi32(0x01400140);
+        const __m128i packQuads = _mm_set1_epi32(0x00011000);
+        const __m128i packBytes = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        bool decoded = false;
+        while (end - src >= 16 && outEnd - out >= 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+
+            const __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(block, 4), mask2F);
+            const __m128i loNibbles = _mm_and_si128(block, mask2F);
+            const __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+            const __m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+            if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0)
+            {
+                break;
+            }
+
+            //character to 6 bit value
+            const __m128i eq2F = _mm_cmpeq_epi8(block, mask2F);
+            const __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+            block = _mm_add_epi8(block, roll);
+
+            //pack 4 x 6 bits into 3 bytes
+            block = _mm_maddubs_epi16(block, packPairs);
+            block = _mm_madd_epi16(block, packQuads);
+            block = _mm_shuffle_epi8(block, packBytes);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), block);
+
+            src += 16;
+            out += 12;
+            decoded = true;
+        }
+        return decoded;
+    }
+#endif //TMX_BASE64_SSSE3
+}
+
+std::size_t tmx::base64_decode(const char* source, std::size_t inSize, unsigned char* dest, std::size_t destSize)
+{
+    static const Base64Table table;
+
+    if (!source || !dest)
+    {
+        return 0;
+    }
+
+    const auto* src = reinterpret_cast<const unsigned char*>(source);
+    const auto* end = src + inSize;
+    auto* out = dest;
+    const auto* outEnd = dest + destSize;
+
+#ifdef TMX_BASE64_SSSE3
+    const bool simd = hasSSSE3();
+#endif
+
+    unsigned char quad[4];
+    auto count = 0;
+    while (src != end)
+    {
+#ifdef TMX_BASE64_SSSE3
+        //the vector loop only starts on a quad boundary
+        if (simd && count == 0
+            && decodeBlocks(src, end, out, outEnd))
+        {
+            continue;
+        }
+#endif
+        const auto value = table.values[*src++];
+        if (value < 64)
+        {
+            quad[count++] = value;
+            if (count == 4)
+            {
+                if (outEnd - out < 3)
+                {
+                    return 0;
+                }
+                *out++ = static_cast<unsigned char>((quad[0] << 2) | (quad[1] >> 4));
+                *out++ = static_cast<unsigned char>((quad[1] << 4) | (quad[2] >> 2));
+                *out++ = static_cast<unsigned char>((quad[2] << 6) | quad[3]);
+                count = 0;
+            }
+        }
+        else if (value == Padding)
+        {
+            break;
+        }
+        else if (value != Whitespace)
+        {
+            return 0;
+        }
+    }
+
+    //a trailing partial quad holds 1 or 2 bytes
+    if (count == 1 || outEnd - out < count - 1)
+    {
+        return 0;
+    }
+    if (count > 1)
+    {
+        *out++ = static_cast<unsigned char>((quad[0] << 2) | (quad[1] >> 4));
+    }
+    if (count > 2)
+    {
+        *out++ = static_cast<unsigned char>((quad[1] << 4) | (quad[2] >> 2));
+    }
+
+    return static_cast<std::size_t>(out - dest);
+}
+
+std::size_t tmx::decompress(const char* source, std::size_t inSize, unsigned char* dest, std::size_t destSize)
+{
+    if (!source || !dest || inSize == 0)
+    {
+        return 0;
+    }
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = (Bytef*)source;
+    stream.avail_in = static_cast<unsigned int>(inSize);
+    stream.next_out = (Bytef*)dest;
+    stream.avail_out = static_cast<unsigned int>(destSize);
+
+#ifdef USE_EXTLIBS
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+#else
+    if (inflateInit(&stream) != Z_OK)
+#endif
+    {
+        return 0;
+    }
+
+    //the output size is known so the whole stream inflates in one call,
+    //anything but the end of the stream means bad or oversized data
+    const auto result = inflate(&stream, Z_FINISH);
+    const std::size_t outSize = destSize - stream.avail_out;
+    inflateEnd(&stream);
+
+    return result == Z_STREAM_END ? outSize : 0;
+}
+
 bool tmx::decompress(const char* source, std::vector<unsigned char>& dest, std::size_t inSize, std::size_t expectedSize)
 {
     if (!source)
@@ -38,8 +38,12 @@ source distribution.
 #include <tmxlite/LayerGroup.hpp>
 #include <tmxlite/detail/Log.hpp>
 #include <tmxlite/detail/Android.hpp>
+#include "detail/XmlFile.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <queue>
+#include <thread>
 
 using namespace tmx;
 
@@ -47,6 +51,7 @@ Map::Map()
     : m_orientation (Orientation::None),
     m_renderOrder   (RenderOrder::None),
     m_infinite      (false),
+    m_fileMapping   (true),
     m_hexSideLength (0.f),
     m_staggerAxis   (StaggerAxis::None),
     m_staggerIndex  (StaggerIndex::None)
@@ -59,9 +64,10 @@ bool Map::load(const std::string& path)
 {
     reset();
 
-    //open the doc
-    pugi::xml_document doc;
-    auto result = doc.load_file(path.c_str());
+    //open the doc, the file is mapped (or read) and parsed in place
+    detail::XmlFile file;
+    auto result = file.load(path, m_fileMapping);
+    const auto& doc = file.getDocument();
     if (!result)
     {
         Logger::log("Failed opening " + path, Logger::Type::Error);
@@ -296,7 +302,7 @@ bool Map::parseMapNode(const pugi::xml_node& mapNode)
         else if (name == "layer")
         {
             m_layers.emplace_back(std::make_unique<TileLayer>(m_tileCount.x * m_tileCount.y));
-            m_layers.back()->parse(node);
+            m_layers.back()->parse(node, this);
         }
         else if (name == "objectgroup")
         {
@@ -327,6 +333,10 @@ bool Map::parseMapNode(const pugi::xml_node& mapNode)
             LOG("Unidentified name " + name + ": node skipped", Logger::Type::Warning);
         }
     }
+
+    //the layer data still points into the document so decode it before it goes
+    decodeTileLayers();
+
     // fill animated tiles for easier lookup into map
     for(const auto& ts : m_tilesets)
     {
@@ -342,6 +352,72 @@ bool Map::parseMapNode(const pugi::xml_node& mapNode)
     return true;
 }
 
+void Map::decodeTileLayers()
+{
+    std::vector<TileLayer*> tileLayers;
+    collectTileLayers(m_layers, tileLayers);
+
+    std::vector<TileLayer::PendingData*> pendingData;
+    for (auto* layer : tileLayers)
+    {
+        for (auto& pending : layer->m_pendingData)
+        {
+            pendingData.push_back(&pending);
+        }
+    }
+
+    //largest first so one big layer doesn't finish last on its own
+    std::sort(pendingData.begin(), pendingData.end(),
+        [](const TileLayer::PendingData* a, const TileLayer::PendingData* b)
+        {
+            return a->textLength > b->textLength;
+        });
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]()
+    {
+        for (auto i = next++; i < pendingData.size(); i = next++)
+        {
+            TileLayer::decode(*pendingData[i]);
+        }
+    };
+
+    //the loading thread works too
+    const std::size_t threadCount = std::min<std::size_t>(pendingData.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (auto i = 1u; i < threadCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    //tiles are created and errors logged on this thread
+    for (auto* layer : tileLayers)
+    {
+        layer->applyPendingData();
+    }
+}
+
+void Map::collectTileLayers(const std::vector<Layer::Ptr>& layers, std::vector<TileLayer*>& tileLayers)
+{
+    for (const auto& layer : layers)
+    {
+        if (layer->getType() == Layer::Type::Tile)
+        {
+            tileLayers.push_back(&layer->getLayerAs<TileLayer>());
+        }
+        else if (layer->getType() == Layer::Type::Group)
+        {
+            collectTileLayers(layer->getLayerAs<LayerGroup>().getLayers(), tileLayers);
+        }
+    }
+}
+
 bool Map::reset()
 {
     m_orientation = Orientation::None;
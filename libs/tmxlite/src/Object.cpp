@@ -35,6 +35,7 @@ source distribution.
 #include <tmxlite/Map.hpp>
 #include <tmxlite/Tileset.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/XmlFile.hpp"
 
 #include <sstream>
 
@@ -224,8 +225,9 @@ void Object::parseTemplate(const std::string& path, Map* map)
     {
         auto templatePath = map->getWorkingDirectory() + "/" + path;
 
-        pugi::xml_document doc;
-        if (!doc.load_file(templatePath.c_str()))
+        detail::XmlFile file;
+        const auto& doc = file.getDocument();
+        if (!file.load(templatePath, map->getFileMapping()))
         {
             Logger::log("Failed opening template file " + path, Logger::Type::Error);
             return;
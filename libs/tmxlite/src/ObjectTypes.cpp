@@ -32,6 +32,7 @@ source distribution.
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/ObjectTypes.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/XmlFile.hpp"
 
 using namespace tmx;
 
@@ -40,8 +41,9 @@ bool ObjectTypes::load(const std::string &path)
     reset();
 
     //open the doc
-    pugi::xml_document doc;
-    auto result = doc.load_file(path.c_str());
+    detail::XmlFile file;
+    auto result = file.load(path);
+    const auto& doc = file.getDocument();
     if (!result)
     {
         Logger::log("Failed opening " + path, Logger::Type::Error);
@@ -40,7 +40,9 @@ source distribution.
 #include <tmxlite/TileLayer.hpp>
 #include <tmxlite/detail/Log.hpp>
 
-#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 using namespace tmx;
 
@@ -62,7 +64,7 @@ TileLayer::TileLayer(std::size_t tileCount)
 }
 
 //public
-void TileLayer::parse(const pugi::xml_node& node, Map*)
+void TileLayer::parse(const pugi::xml_node& node, Map* map)
 {
     std::string attribName = node.name();
     if (attribName != "layer")
@@ -94,6 +96,16 @@ void TileLayer::parse(const pugi::xml_node& node, Map*)
             if (attribName == "base64")
             {
                 parseBase64(child);
+
+                //a map decodes the data of all its layers at once, see Map::decodeTileLayers()
+                if (!map)
+                {
+                    for (auto& pending : m_pendingData)
+                    {
+                        decode(pending);
+                    }
+                    applyPendingData();
+                }
             }
             else if (attribName == "csv")
             {
@@ -116,72 +128,120 @@ void TileLayer::parse(const pugi::xml_node& node, Map*)
 }
 
 //private
-void TileLayer::parseBase64(const pugi::xml_node& node)
+void TileLayer::decode(PendingData& pending)
 {
-    auto processDataString = [](std::string dataString, std::size_t tileCount, std::int32_t compressionType)->std::vector<std::uint32_t>
+    //decode straight into the GID buffer, tiles are 4 little endian bytes each
+    const std::size_t expectedSize = pending.tileCount * 4;
+    pending.IDs.resize(pending.tileCount);
+    auto* dest = reinterpret_cast<unsigned char*>(pending.IDs.data());
+
+    std::size_t size = 0;
+    if (pending.compression == CompressionType::None)
     {
-        std::stringstream ss;
-        ss << dataString;
-        ss >> dataString;
-        dataString = base64_decode(dataString);
+        size = base64_decode(pending.text, pending.textLength, dest, expectedSize);
+    }
+    else
+    {
+        //compressed bytes, reused by all the layers decoded on this thread
+        thread_local std::vector<unsigned char> byteData;
+        byteData.resize(base64_decodedSize(pending.textLength));
 
-        std::size_t expectedSize = tileCount * 4; //4 bytes per tile
-        std::vector<unsigned char> byteData;
-        byteData.reserve(expectedSize);
+        const auto dataSize = base64_decode(pending.text, pending.textLength, byteData.data(), byteData.size());
+        if (dataSize == 0)
+        {
+            pending.error = "Invalid base64 layer data";
+            pending.IDs.clear();
+            return;
+        }
 
-        switch (compressionType)
+        switch (pending.compression)
         {
-        default:
-            byteData.insert(byteData.end(), dataString.begin(), dataString.end());
-            break;
+        default: break;
         case CompressionType::Zstd:
 #if defined USE_ZSTD || defined USE_EXTLIBS
             {
-                std::size_t dataSize = dataString.length() * sizeof(unsigned char);
-                std::size_t result = ZSTD_decompress(byteData.data(), expectedSize, &dataString[0], dataSize);
-                
+                auto result = ZSTD_decompress(dest, expectedSize, byteData.data(), dataSize);
                 if (ZSTD_isError(result))
                 {
-                    std::string err = ZSTD_getErrorName(result);
-                    LOG("Failed to decompress layer data, node skipped.\nError: " + err, Logger::Type::Error);
+                    pending.error = std::string("Failed to decompress layer data.\nError: ") + ZSTD_getErrorName(result);
+                    pending.IDs.clear();
+                    return;
                 }
+                size = result;
             }
 #else
-            Logger::log("Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression", Logger::Type::Error);
-            return {};
+            pending.error = "Library must be built with USE_EXTLIBS or USE_ZSTD for Zstd compression";
+            pending.IDs.clear();
+            return;
 #endif
+            break;
         case CompressionType::GZip:
 #ifndef USE_EXTLIBS
-            Logger::log("Library must be built with USE_EXTLIBS for GZip compression", Logger::Type::Error);
-            return {};
+            pending.error = "Library must be built with USE_EXTLIBS for GZip compression";
+            pending.IDs.clear();
+            return;
 #endif
             //[[fallthrough]];
         case CompressionType::Zlib:
+            size = decompress(reinterpret_cast<const char*>(byteData.data()), dataSize, dest, expectedSize);
+            break;
+        }
+    }
+
+    if (size != expectedSize)
+    {
+        pending.error = "Layer data is " + std::to_string(size) + " bytes, expected " + std::to_string(expectedSize);
+        pending.IDs.clear();
+        return;
+    }
+
+    //the bytes are little endian
+    const std::uint16_t endianTest = 1;
+    if (*reinterpret_cast<const unsigned char*>(&endianTest) == 0)
+    {
+        for (auto& id : pending.IDs)
         {
-            //unzip
-            std::size_t dataSize = dataString.length() * sizeof(unsigned char);
+            id = (id >> 24) | ((id >> 8) & 0xff00) | ((id << 8) & 0xff0000) | (id << 24);
+        }
+    }
+}
 
-            if (!decompress(dataString.c_str(), byteData, dataSize, expectedSize))
-            {
-                LOG("Failed to decompress layer data, node skipped.", Logger::Type::Error);
-                return {};
-            }
+void TileLayer::applyPendingData()
+{
+    for (auto& pending : m_pendingData)
+    {
+        if (!pending.error.empty())
+        {
+            LOG(pending.error, Logger::Type::Error);
+            Logger::log("Failed to decode data of layer " + getName() + ", data skipped.", Logger::Type::Error);
         }
-            break;
+        else if (pending.chunkIndex < 0)
+        {
+            createTiles(pending.IDs, m_tiles);
+        }
+        else
+        {
+            createTiles(pending.IDs, m_chunks[pending.chunkIndex].tiles);
         }
+    }
 
-        //data stream is in bytes so we need to OR into 32 bit values
-        std::vector<std::uint32_t> IDs;
-        IDs.reserve(tileCount);
-        for (auto i = 0u; i < expectedSize - 3u; i += 4u)
+    if (!m_chunks.empty())
+    {
+        m_chunks.erase(std::remove_if(m_chunks.begin(), m_chunks.end(),
+            [](const Chunk& chunk) { return chunk.tiles.empty(); }), m_chunks.end());
+
+        if (m_chunks.empty())
         {
-            std::uint32_t id = byteData[i] | byteData[i + 1] << 8 | byteData[i + 2] << 16 | byteData[i + 3] << 24;
-            IDs.push_back(id);
+            Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
         }
+    }
 
-        return IDs;
-    };
+    m_pendingData.clear();
+    m_pendingData.shrink_to_fit();
+}
 
+void TileLayer::parseBase64(const pugi::xml_node& node)
+{
     std::int32_t compressionType = CompressionType::None;
     std::string compression = node.attribute("compression").as_string();
     if (compression == "gzip")
@@ -197,18 +257,29 @@ void TileLayer::parseBase64(const pugi::xml_node& node)
         compressionType = CompressionType::Zstd;
     }
 
-    std::string data = node.text().as_string();
-    if (data.empty())
+    //only record where the text is, decoding happens in decode()
+    auto addPendingData = [&](const char* text, std::size_t tileCount, std::int32_t chunkIndex)
+    {
+        m_pendingData.emplace_back();
+        auto& pending = m_pendingData.back();
+        pending.text = text;
+        pending.textLength = std::strlen(text);
+        pending.compression = compressionType;
+        pending.tileCount = tileCount;
+        pending.chunkIndex = chunkIndex;
+    };
+
+    const char* data = node.text().get();
+    if (*data == 0)
     {
         //check for chunk nodes
-        auto dataCount = 0;
         for (const auto& childNode : node.children())
         {
             std::string childName = childNode.name();
             if (childName == "chunk")
             {
-                std::string dataString = childNode.text().as_string();
-                if (!dataString.empty())
+                const char* dataString = childNode.text().get();
+                if (*dataString != 0)
                 {
                     Chunk chunk;
                     chunk.position.x = childNode.attribute("x").as_int();
@@ -217,19 +288,13 @@ void TileLayer::parseBase64(const pugi::xml_node& node)
                     chunk.size.x = childNode.attribute("width").as_int();
                     chunk.size.y = childNode.attribute("height").as_int();
 
-                    auto IDs = processDataString(dataString, (chunk.size.x * chunk.size.y), compressionType);
-
-                    if (!IDs.empty())
-                    {
-                        createTiles(IDs, chunk.tiles);
-                        m_chunks.push_back(chunk);
-                        dataCount++;
-                    }                    
+                    addPendingData(dataString, chunk.size.x * chunk.size.y, static_cast<std::int32_t>(m_chunks.size()));
+                    m_chunks.push_back(chunk);
                 }
             }
         }
 
-        if (dataCount == 0)
+        if (m_chunks.empty())
         {
             Logger::log("Layer " + getName() + " has no layer data. Layer skipped.", Logger::Type::Error);
             return;
@@ -237,8 +302,7 @@ void TileLayer::parseBase64(const pugi::xml_node& node)
     }
     else
     {
-        auto IDs = processDataString(data, m_tileCount, compressionType);
-        createTiles(IDs, m_tiles);
+        addPendingData(data, m_tileCount, -1);
     }
 }
 
@@ -331,6 +395,7 @@ void TileLayer::createTiles(const std::vector<std::uint32_t>& IDs, std::vector<T
     //    + std::to_string(IDs.size()) + ", expected: " + std::to_string(m_tileCount));
     
     static const std::uint32_t mask = 0xf0000000;
+    destination.reserve(destination.size() + IDs.size());
     for (const auto& id : IDs)
     {
         destination.emplace_back();
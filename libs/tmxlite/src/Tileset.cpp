@@ -31,13 +31,70 @@ source distribution.
 #include "detail/pugixml.hpp"
 #endif
 #include <tmxlite/Tileset.hpp>
+#include <tmxlite/Map.hpp>
 #include <tmxlite/FreeFuncs.hpp>
 #include <tmxlite/detail/Log.hpp>
+#include "detail/XmlFile.hpp"
+
+#include <sys/stat.h>
 
 #include <ctype.h>
+#include <mutex>
+#include <unordered_map>
 
 using namespace tmx;
 
+namespace
+{
+    //modification time and size of a file, tells when a cached tsx is stale
+    struct FileStamp final
+    {
+        std::int64_t modified = 0;
+        std::int64_t size = 0;
+
+        bool operator == (const FileStamp& other) const
+        {
+            return modified == other.modified && size == other.size;
+        }
+    };
+
+    bool getFileStamp(const std::string& path, FileStamp& stamp)
+    {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            return false;
+        }
+
+#if defined(__linux__) || defined(__ANDROID__)
+        stamp.modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#else
+        stamp.modified = static_cast<std::int64_t>(info.st_mtime);
+#endif
+        stamp.size = static_cast<std::int64_t>(info.st_size);
+        return true;
+    }
+
+    struct CachedTileset final
+    {
+        Tileset tileset;
+        FileStamp stamp;
+    };
+
+    //parsed tsx files [ key = resolved path ], maps may load on several threads
+    std::mutex& getCacheMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::unordered_map<std::string, CachedTileset>& getCache()
+    {
+        static std::unordered_map<std::string, CachedTileset> cache;
+        return cache;
+    }
+}
+
 Tileset::Tileset(const std::string& workingDir)
     : m_workingDir          (workingDir),
     m_firstGID              (0),
@@ -71,7 +128,9 @@ void Tileset::parse(pugi::xml_node node, Map* map)
         return;
     }
 
-    pugi::xml_document tsxDoc; //need to keep this in scope
+    detail::XmlFile tsxFile; //need to keep this in scope
+    std::string tsxPath;
+    FileStamp tsxStamp;
     if (node.attribute("source"))
     {
         //parse TSX doc
@@ -90,8 +149,24 @@ void Tileset::parse(pugi::xml_node node, Map* map)
             m_workingDir = "";
         }
 
+        //reuse the tile set if another map already parsed this tsx
+        if (getFileStamp(path, tsxStamp))
+        {
+            std::lock_guard<std::mutex> lock(getCacheMutex());
+            auto cached = getCache().find(path);
+            if (cached != getCache().end()
+                && cached->second.stamp == tsxStamp)
+            {
+                const auto firstGID = m_firstGID;
+                *this = cached->second.tileset;
+                setFirstGID(firstGID);
+                return;
+            }
+            tsxPath = path;
+        }
+
         //see if doc can be opened
-        auto result = tsxDoc.load_file(path.c_str());
+        auto result = tsxFile.load(path, map->getFileMapping());
         if (!result)
         {
             Logger::log(path + ": Failed opening tsx file for tile set, tile set will be skipped", Logger::Type::Error);
@@ -99,7 +174,7 @@ void Tileset::parse(pugi::xml_node node, Map* map)
         }
 
         //if it can then replace the current node with tsx node
-        node = tsxDoc.child("tileset");
+        node = tsxFile.getDocument().child("tileset");
         if (!node)
         {
             Logger::log("tsx file does not contain a tile set node, tile set will be skipped", Logger::Type::Error);
@@ -227,6 +302,19 @@ void Tileset::parse(pugi::xml_node node, Map* map)
             createMissingTile(ID);
         }
     }
+
+    if (!tsxPath.empty())
+    {
+        std::lock_guard<std::mutex> lock(getCacheMutex());
+        getCache().erase(tsxPath);
+        getCache().emplace(tsxPath, CachedTileset{ *this, tsxStamp });
+    }
+}
+
+void Tileset::clearCache()
+{
+    std::lock_guard<std::mutex> lock(getCacheMutex());
+    getCache().clear();
 }
 
 std::uint32_t Tileset::getLastGID() const
@@ -249,6 +337,20 @@ const Tileset::Tile* Tileset::getTile(std::uint32_t id) const
 }
 
 //private
+void Tileset::setFirstGID(std::uint32_t firstGID)
+{
+    //animation frames store global IDs
+    const auto offset = firstGID - m_firstGID;
+    for (auto& tile : m_tiles)
+    {
+        for (auto& frame : tile.animation.frames)
+        {
+            frame.tileID += offset;
+        }
+    }
+    m_firstGID = firstGID;
+}
+
 void Tileset::reset()
 {
     m_firstGID = 0;
@@ -0,0 +1,175 @@
+/*********************************************************************
+Matt Marchant 2016 - 2023
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#include "detail/XmlFile.hpp"
+
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TMX_HAS_MMAP
+#endif
+
+using namespace tmx::detail;
+
+XmlFile::~XmlFile()
+{
+    //the document references the mapped memory so it goes first
+    m_document.reset();
+    unmap();
+}
+
+//public
+pugi::xml_parse_result XmlFile::load(const std::string& path, bool mapFile)
+{
+    m_document.reset();
+    unmap();
+
+    if (!mapFile || !map(path))
+    {
+        //read the whole file into our own buffer instead
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            pugi::xml_parse_result result;
+            result.status = pugi::status_file_not_found;
+            return result;
+        }
+
+        m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size())))
+        {
+            pugi::xml_parse_result result;
+            result.status = pugi::status_io_error;
+            return result;
+        }
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+    }
+
+    //no copy of the text is made, strings point into the mapped file or the buffer
+    return m_document.load_buffer_inplace(m_data, m_size);
+}
+
+//private
+bool XmlFile::map(const std::string& path)
+{
+#ifdef TMX_HAS_MMAP
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd); //the mapping keeps its own reference to the file
+
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_mapped = true;
+    m_data = data;
+    m_size = size;
+    return true;
+
+#elif defined(_WIN32)
+    auto file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    auto mapping = ::CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    ::CloseHandle(file);
+    if (!mapping)
+    {
+        return false;
+    }
+
+    auto* data = ::MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!data)
+    {
+        ::CloseHandle(mapping);
+        return false;
+    }
+
+    m_mapped = true;
+    m_mapping = mapping;
+    m_data = data;
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    return true;
+
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void XmlFile::unmap()
+{
+    if (m_mapped)
+    {
+#ifdef TMX_HAS_MMAP
+        ::munmap(m_data, m_size);
+#elif defined(_WIN32)
+        ::UnmapViewOfFile(m_data);
+        ::CloseHandle(m_mapping);
+        m_mapping = nullptr;
+#endif
+    }
+
+    m_mapped = false;
+    m_data = nullptr;
+    m_size = 0;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+}
@@ -0,0 +1,80 @@
+/*********************************************************************
+Matt Marchant 2016 - 2023
+http://trederia.blogspot.com
+
+tmxlite - Zlib license.
+
+This software is provided 'as-is', without any express or
+implied warranty. In no event will the authors be held
+liable for any damages arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute
+it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented;
+you must not claim that you wrote the original software.
+If you use this software in a product, an acknowledgment
+in the product documentation would be appreciated but
+is not required.
+
+2. Altered source versions must be plainly marked as such,
+and must not be misrepresented as being the original software.
+
+3. This notice may not be removed or altered from any
+source distribution.
+*********************************************************************/
+
+#pragma once
+
+#ifdef USE_EXTLIBS
+#include <pugixml.hpp>
+#else
+#include "pugixml.hpp"
+#endif
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace tmx
+{
+    namespace detail
+    {
+        /*!
+        \brief Maps an xml file into memory and parses it in place.
+        The mapping is private (copy on write) so the in situ parser never
+        writes back to the file. The file is read into a buffer on platforms
+        without memory mapping, or when mapping is not wanted. Nodes are only
+        valid while the XmlFile exists.
+        */
+        class XmlFile final
+        {
+        public:
+            XmlFile() = default;
+            ~XmlFile();
+
+            XmlFile(const XmlFile&) = delete;
+            XmlFile& operator = (const XmlFile&) = delete;
+
+            //a file that may be rewritten during the parse should not be
+            //mapped, truncating a mapped file raises SIGBUS on access
+            pugi::xml_parse_result load(const std::string& path, bool mapFile = true);
+
+            const pugi::xml_document& getDocument() const { return m_document; }
+
+        private:
+            pugi::xml_document m_document;
+            void* m_data = nullptr;
+            std::size_t m_size = 0;
+            bool m_mapped = false;
+#ifdef _WIN32
+            void* m_mapping = nullptr;
+#endif
+            std::vector<char> m_buffer;
+
+            bool map(const std::string& path);
+            void unmap();
+        };
+    }
+}
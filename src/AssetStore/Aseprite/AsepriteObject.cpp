@@ -1,103 +1,404 @@
 #include "AsepriteObject.h"
 
-#include "AssetStore/AssetStore.h"
-
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include <nlohmann/json.hpp>
+#include <sstream>
 
 using json = nlohmann::json;
 
+namespace {
+    // Json objects/arrays the loader is interested in, everything else is skipped
+    enum class Node : std::uint8_t {
+        ROOT,
+        FRAMES,       // "frames": [ ... ] or "frames": { "name": { ... } }
+        FRAME,        // "frames"[i]
+        FRAME_RECT,   // "frames"[i]."frame"
+        SOURCE_SIZE,  // "frames"[i]."sourceSize"
+        META,         // "meta"
+        META_SIZE,    // "meta"."size"
+        FRAME_TAGS,   // "meta"."frameTags"
+        FRAME_TAG,    // "meta"."frameTags"[i]
+        SKIP,
+    };
+
+    enum class Key : std::uint8_t {
+        OTHER,
+        FRAMES,
+        META,
+        FRAME,
+        SOURCE_SIZE,
+        DURATION,
+        X,
+        Y,
+        W,
+        H,
+        SIZE,
+        SCALE,
+        IMAGE,
+        FRAME_TAGS,
+        NAME,
+        FROM,
+        TO,
+        DIRECTION,
+    };
+
+    // Mandatory fields of a frame
+    constexpr unsigned FIELD_FRAME = 1u << 0;
+    constexpr unsigned FIELD_SOURCE_SIZE = 1u << 1;
+    constexpr unsigned FIELD_DURATION = 1u << 2;
+    constexpr unsigned FIELD_ALL = FIELD_FRAME | FIELD_SOURCE_SIZE | FIELD_DURATION;
+
+    Key ToKey(const std::string& key) {
+        static const std::pair<const char*, Key> keys[] = {
+            { "frames", Key::FRAMES },   { "meta", Key::META },
+            { "frame", Key::FRAME },     { "sourceSize", Key::SOURCE_SIZE },
+            { "duration", Key::DURATION }, { "x", Key::X },
+            { "y", Key::Y },             { "w", Key::W },
+            { "h", Key::H },             { "size", Key::SIZE },
+            { "scale", Key::SCALE },     { "image", Key::IMAGE },
+            { "frameTags", Key::FRAME_TAGS }, { "name", Key::NAME },
+            { "from", Key::FROM },       { "to", Key::TO },
+            { "direction", Key::DIRECTION },
+        };
+        for (const auto& [name, value] : keys) {
+            if (key == name)
+                return value;
+        }
+        return Key::OTHER;
+    }
+
+    // Returns the node of a new object/array opened inside `parent` under `key`
+    Node GetChildNode(Node parent, Key key) {
+        switch (parent) {
+            case Node::ROOT:
+                if (key == Key::FRAMES)
+                    return Node::FRAMES;
+                return key == Key::META ? Node::META : Node::SKIP;
+            case Node::FRAMES:
+                return Node::FRAME;  // array item or hash value, the key is the file name
+            case Node::FRAME:
+                if (key == Key::FRAME)
+                    return Node::FRAME_RECT;
+                return key == Key::SOURCE_SIZE ? Node::SOURCE_SIZE : Node::SKIP;
+            case Node::META:
+                if (key == Key::SIZE)
+                    return Node::META_SIZE;
+                return key == Key::FRAME_TAGS ? Node::FRAME_TAGS : Node::SKIP;
+            case Node::FRAME_TAGS:
+                return Node::FRAME_TAG;
+            default:
+                return Node::SKIP;
+        }
+    }
+
+    // Fills AsepriteObject directly from the parser events
+    class AsepriteSaxHandler : public nlohmann::json_sax<json> {
+        AsepriteObject& object;
+        const std::string& jsonPath;
+        std::vector<Node> nodes;
+        Key currentKey = Key::OTHER;
+        unsigned frameFields = 0;
+
+    public:
+        bool hasMeta = false;
+        bool hasFrameTags = false;
+
+        AsepriteSaxHandler(AsepriteObject& object, const std::string& jsonPath)
+            : object(object)
+            , jsonPath(jsonPath) {
+            nodes.reserve(8);
+        }
+
+        bool null() override {
+            return true;
+        }
+
+        bool boolean(bool) override {
+            return true;
+        }
+
+        bool number_integer(number_integer_t val) override {
+            return SetNumber(static_cast<double>(val));
+        }
+
+        bool number_unsigned(number_unsigned_t val) override {
+            return SetNumber(static_cast<double>(val));
+        }
+
+        bool number_float(number_float_t val, const string_t&) override {
+            return SetNumber(val);
+        }
+
+        bool string(string_t& val) override {
+            if (nodes.empty())
+                return true;
+
+            switch (nodes.back()) {
+                case Node::META:
+                    if (currentKey == Key::IMAGE)
+                        object.imageName = std::move(val);
+                    else if (currentKey == Key::SCALE)
+                        object.scale = std::strtof(val.c_str(), nullptr);  // "scale": "1"
+                    break;
+                case Node::FRAME_TAG:
+                    if (currentKey == Key::NAME) {
+                        object.frameTags.back().name = std::move(val);
+                    } else if (currentKey == Key::DIRECTION) {
+                        auto& direction = object.frameTags.back().direction;
+                        if (val == "reverse")
+                            direction = TagDirection::REVERSE;
+                        else if (val == "pingpong")
+                            direction = TagDirection::PINGPONG;
+                        else
+                            direction = TagDirection::FORWARD;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        bool binary(binary_t&) override {
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            const Node node = nodes.empty() ? Node::ROOT : GetChildNode(nodes.back(), currentKey);
+            switch (node) {
+                case Node::FRAME:
+                    object.frames.emplace_back();
+                    frameFields = 0;
+                    break;
+                case Node::FRAME_RECT:
+                    frameFields |= FIELD_FRAME;
+                    break;
+                case Node::SOURCE_SIZE:
+                    frameFields |= FIELD_SOURCE_SIZE;
+                    break;
+                case Node::META:
+                    hasMeta = true;
+                    break;
+                case Node::FRAME_TAG:
+                    object.frameTags.emplace_back();
+                    break;
+                case Node::FRAME_TAGS:  // must be an array
+                    nodes.push_back(Node::SKIP);
+                    return true;
+                default:
+                    break;
+            }
+            nodes.push_back(node);
+            return true;
+        }
+
+        bool key(string_t& val) override {
+            currentKey = ToKey(val);
+            return true;
+        }
+
+        bool end_object() override {
+            if (nodes.back() == Node::FRAME && frameFields != FIELD_ALL) {
+                spdlog::error("JSON frames data is incorrect: {}", jsonPath);
+                return false;
+            }
+            nodes.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t elements) override {
+            const Node node = nodes.empty() ? Node::SKIP : GetChildNode(nodes.back(), currentKey);
+            if (node == Node::FRAMES) {
+                object.frames.reserve(elements != static_cast<std::size_t>(-1) ? elements : 0);
+            } else if (node == Node::FRAME_TAGS) {
+                hasFrameTags = true;
+            } else {
+                nodes.push_back(Node::SKIP);
+                return true;
+            }
+            nodes.push_back(node);
+            return true;
+        }
+
+        bool end_array() override {
+            nodes.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t position, const std::string&,
+                         const nlohmann::detail::exception& ex) override {
+            spdlog::error("Failed to parse Aseprite json {} at {}: {}", jsonPath, position, ex.what());
+            return false;
+        }
+
+    private:
+        bool SetNumber(double val) {
+            if (nodes.empty())
+                return true;
+
+            const int value = static_cast<int>(val);
+            switch (nodes.back()) {
+                case Node::FRAME:
+                    if (currentKey == Key::DURATION) {
+                        object.frames.back().duration = value;
+                        frameFields |= FIELD_DURATION;
+                    }
+                    break;
+                case Node::FRAME_RECT: {
+                    auto& frame = object.frames.back();
+                    if (currentKey == Key::X)
+                        frame.x = value;
+                    else if (currentKey == Key::Y)
+                        frame.y = value;
+                    else if (currentKey == Key::W)
+                        frame.width = value;
+                    else if (currentKey == Key::H)
+                        frame.height = value;
+                    break;
+                }
+                case Node::SOURCE_SIZE:
+                    if (currentKey == Key::W)
+                        object.frames.back().sourceWidth = value;
+                    else if (currentKey == Key::H)
+                        object.frames.back().sourceHeight = value;
+                    break;
+                case Node::META:
+                    if (currentKey == Key::SCALE)
+                        object.scale = static_cast<float>(val);
+                    break;
+                case Node::META_SIZE:
+                    if (currentKey == Key::W)
+                        object.size.first = value;
+                    else if (currentKey == Key::H)
+                        object.size.second = value;
+                    break;
+                case Node::FRAME_TAG:
+                    if (currentKey == Key::FROM)
+                        object.frameTags.back().from = value;
+                    else if (currentKey == Key::TO)
+                        object.frameTags.back().to = value;
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+    };
+}  // namespace
+
 bool AsepriteObject::Load(const std::string& jsonPath) {
-    std::ifstream f(jsonPath);
-    json data = json::parse(f);
-    if (data.is_null() || !data.is_object()) {
+    std::ifstream f(jsonPath, std::ios::binary);
+    if (!f.is_open()) {
         spdlog::error("Json file doesn't exist: {}", jsonPath);
         return false;
     }
-    if (!data["meta"].is_object()) {
-        spdlog::error("Meta data is incorrect: {}", jsonPath);
-        return false;
-    }
 
-    // Read meta data
-    auto meta = data["meta"];
-    spdlog::info("Aseprite json opened.");
+    // Read the whole file at once, parsing a contiguous buffer is faster than a stream
+    std::ostringstream buffer;
+    buffer << f.rdbuf();
+    const std::string content = buffer.str();
+
+    frames.clear();
+    frameTags.clear();
 
-    if (!meta.contains("size") || !meta["size"].is_object() || !meta.contains("scale")
-        || (!meta["scale"].is_string() && !meta["scale"].is_number()) || !meta.contains("image")
-        || !meta["image"].is_string()) {
+    AsepriteSaxHandler handler(*this, jsonPath);
+    if (!json::sax_parse(content, &handler))
+        return false;
+
+    if (!handler.hasMeta || imageName.empty()) {
         spdlog::error("Aseprite meta data is incorrect: {}", jsonPath);
         return false;
     }
-    size.first = meta["size"]["w"].get<int>();
-    size.second = meta["size"]["h"].get<int>();
-
-    // Handle scale as a string or a number
-    if (meta["scale"].is_string()) {
-        scale = std::atof(meta["scale"].get<std::string>().c_str()); // Convert string to float
-    } else {
-        scale = meta["scale"].get<float>(); // Directly extract number
+    if (!handler.hasFrameTags) {
+        spdlog::error("JSON does not contain valid frameTags: {}", jsonPath);
+        return false;
     }
 
-    imageName = meta["image"].get<std::string>();
+    if (!BuildTimeline(jsonPath))
+        return false;
 
-    // Read frames data
-    auto framesArray = data["frames"];
-    for (auto item : framesArray) {
-        if (!item.contains("frame") || !item.contains("sourceSize") || !item.contains("duration")) {
-            spdlog::error("JSON frames data is incorrect: {}", jsonPath);
-            return false;
-        }
-        if (!item["frame"].is_object() || !item["sourceSize"].is_object()
-            || !item["duration"].is_number()) {
-            spdlog::warn("JSON frames data is incorrect: {}", jsonPath);
-            continue;
-        }
-        // Allocate memory
-        auto frame = std::make_shared<FrameObject>();
+    spdlog::info("All Aseprite data extracted: {}", jsonPath);
+    return true;
+}
 
-        // Init pointers
-        frame->objectFrames = std::make_shared<FrameData>();
+bool AsepriteObject::BuildTimeline(const std::string& jsonPath) {
+    if (frames.empty()) {
+        spdlog::error("JSON frames data is incorrect: {}", jsonPath);
+        return false;
+    }
 
-        // Set data
-        frame->objectFrames->x = item["frame"]["x"].get<int>();
-        frame->objectFrames->y = item["frame"]["y"].get<int>();
-        frame->objectFrames->width = item["frame"]["w"].get<int>();
-        frame->objectFrames->height = item["frame"]["h"].get<int>();
-        frame->spriteSize.first = item["sourceSize"]["w"].get<int>();
-        frame->spriteSize.second = item["sourceSize"]["h"].get<int>();
-        frame->frameDuration = item["duration"].get<int>();
+    // Prefix sums of the frame durations
+    frameTimeline.resize(frames.size() + 1);
+    frameTimeline[0] = 0;
+    for (size_t i = 0; i < frames.size(); i++)
+        frameTimeline[i + 1] = frameTimeline[i] + std::max(frames[i].duration, 0);
 
-        // Add data
-        frames.push_back(frame);
+    // Check frame range
+    const int frameCount = static_cast<int>(frames.size());
+    auto invalid = std::remove_if(frameTags.begin(), frameTags.end(), [&](const FrameTag& tag) {
+        return tag.from < 0 || tag.from >= frameCount || tag.to < tag.from || tag.to >= frameCount;
+    });
+    if (invalid != frameTags.end()) {
+        spdlog::warn("JSON frame range is incorrect: {}", jsonPath);
+        frameTags.erase(invalid, frameTags.end());
     }
 
-    // Read animation tags
-    if (!meta.contains("frameTags") || !meta["frameTags"].is_array()) {
-        spdlog::error("JSON does not contain valid frameTags: {}", jsonPath);
-        return false;
+    for (auto& tag : frameTags) {
+        tag.duration = frameTimeline[tag.to + 1] - frameTimeline[tag.from];
+
+        // Uniform durations allow the O(1) lookup
+        tag.frameDuration = frames[tag.from].duration;
+        for (int i = tag.from + 1; i <= tag.to; i++) {
+            if (frames[i].duration != tag.frameDuration) {
+                tag.frameDuration = 0;
+                break;
+            }
+        }
     }
-    for (const auto& item : meta["frameTags"]) {
-        if (!item.contains("name") || !item["name"].is_string() || !item.contains("from")
-            || !item["from"].is_number_integer() || !item.contains("to")
-            || !item["to"].is_number_integer()) {
-            spdlog::warn("Invalid frameTag entry in JSON: {}", jsonPath);
-            continue;
-        }
-        auto name = item["name"].get<std::string>();
-
-        // Check frame range
-        int start = item["from"].get<int>();
-        int end = item["to"].get<int>();
-        if (start < 0 || start >= static_cast<int>(framesArray.size()) || end < 0
-            || end >= static_cast<int>(framesArray.size())) {
-            spdlog::warn("JSON frame range is incorrect: {}", jsonPath);
-            continue;
-        }
-        frameTags->emplace(name, std::make_pair(start, end));
+    return true;
+}
+
+int AsepriteObject::GetTagIndex(const std::string& name) const {
+    for (size_t i = 0; i < frameTags.size(); i++) {
+        if (frameTags[i].name == name)
+            return static_cast<int>(i);
     }
+    return -1;
+}
 
-    spdlog::info("All Aseprite data extracted: {}", jsonPath);
-    return true;
-}
\ No newline at end of file
+int AsepriteObject::GetFrameIndex(int tagIndex, int elapsedTime) const {
+    if (tagIndex < 0 || tagIndex >= static_cast<int>(frameTags.size()))
+        return 0;
+
+    const auto& tag = frameTags[tagIndex];
+    if (tag.duration <= 0)
+        return tag.from;
+
+    // Wrap the time around the tag
+    int time = std::max(elapsedTime, 0);
+    switch (tag.direction) {
+        case TagDirection::FORWARD:
+            time %= tag.duration;
+            break;
+        case TagDirection::REVERSE:
+            time = tag.duration - 1 - time % tag.duration;
+            break;
+        case TagDirection::PINGPONG:
+            time %= 2 * tag.duration;
+            if (time >= tag.duration)
+                time = 2 * tag.duration - 1 - time;
+            break;
+    }
+
+    if (tag.frameDuration > 0)
+        return tag.from + time / tag.frameDuration;
+
+    // Last frame that starts before `time`
+    const auto first = frameTimeline.begin() + tag.from;
+    const auto last = frameTimeline.begin() + tag.to + 1;
+    const auto frame = std::upper_bound(first, last, frameTimeline[tag.from] + time);
+    return static_cast<int>(frame - frameTimeline.begin()) - 1;
+}
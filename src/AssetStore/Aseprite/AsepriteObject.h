@@ -1,43 +1,59 @@
 #ifndef ASEPRITEOBJECT_H
 #define ASEPRITEOBJECT_H
 
-#include <map>
+#include <cstdint>
 #include <string>
-#include <tuple>
+#include <utility>
 #include <vector>
 
-// Stores Aseprite json "frame": { "x": 0, "y": 0, "w": 224, "h": 224 }
+// Compact index of an Aseprite object inside the AssetStore
+using AsepriteHandle = std::uint32_t;
+constexpr AsepriteHandle INVALID_ASEPRITE_HANDLE = UINT32_MAX;
+
+// Stores one Aseprite json frame:
+// "frame": { "x": 0, "y": 0, "w": 224, "h": 224 }, "sourceSize": { "w": 224, "h": 224 }, "duration": 100
 struct FrameData {
     int x;
     int y;
     int width;
     int height;
-
-    FrameData(int _x, int _y, int _width, int _height)
-        : x(_x)
-        , y(_y)
-        , width(_width)
-        , height(_height) {
-    }
+    int sourceWidth;
+    int sourceHeight;
+    int duration;  // milliseconds
 
     FrameData()
         : x(0)
         , y(0)
         , width(0)
-        , height(0) {
+        , height(0)
+        , sourceWidth(0)
+        , sourceHeight(0)
+        , duration(0) {
     }
 };
 
-// Stores frame data
-struct FrameObject {
-    std::shared_ptr<FrameData> objectFrames;
-    std::pair<int, int> spriteSize;
-    int frameDuration;
+enum class TagDirection : std::uint8_t {
+    FORWARD = 0,
+    REVERSE,
+    PINGPONG,
+};
+
+// Stores Aseprite json "frameTags": { "name": "***", "from": 2, "to": 4, "direction": "forward" }
+struct FrameTag {
+    std::string name;
+    int from;
+    int to;
+    TagDirection direction;
+    int duration;       // total duration of the tag frames, milliseconds
+    int frameDuration;  // duration of every frame if they are all equal, otherwise 0
 
-    FrameObject()
-        : objectFrames(std::make_shared<FrameData>())
-        , spriteSize({ 0, 0 })
-        , frameDuration(0) {}
+    FrameTag()
+        : from(0)
+        , to(0)
+        , direction(TagDirection::FORWARD)
+        , duration(0)
+        , frameDuration(0) {
+    }
 };
 
 // Stores Aseprite json data
@@ -45,17 +61,35 @@ struct AsepriteObject {
     std::pair<int, int> size;
     float scale;
     std::string imageName;
-    std::shared_ptr<std::map<std::string, std::pair<int, int>>> frameTags;  // { "name": "***",
-                                                                            // "from": 2, "to": 4}
-    std::vector<std::shared_ptr<FrameObject>> frames;
+
+    // Contiguous frames array [ index = frame index ]
+    std::vector<FrameData> frames;
+
+    // Cumulative frame durations, `frameTimeline[i]` is the start time of the frame `i`,
+    // the last value is the duration of the whole sprite sheet [ size = frames + 1 ]
+    std::vector<int> frameTimeline;
+
+    // Small flat table of animation tags, searched linearly
+    std::vector<FrameTag> frameTags;
 
     AsepriteObject()
         : size{ 0, 0 }
-        , scale(1.0f)
-        , frameTags(std::make_shared<std::map<std::string, std::pair<int, int>>>()) {
+        , scale(1.0f) {
     }
 
+    // Streams the json file through a SAX parser, no DOM is built
     bool Load(const std::string& jsonPath);
+
+    // Returns the tag index or -1 if the tag doesn't exist
+    int GetTagIndex(const std::string& name) const;
+
+    // Returns the frame index of the tag at the given time, wraps the time around the tag.
+    // O(1) when all the tag frames have the same duration, O(log n) otherwise
+    int GetFrameIndex(int tagIndex, int elapsedTime) const;
+
+private:
+    // Builds `frameTimeline` and the tag durations once all the data has been read
+    bool BuildTimeline(const std::string& jsonPath);
 };
 
 #endif  // ASEPRITEOBJECT_H
@@ -1,20 +1,71 @@
 #include "AssetStore.h"
 
 #include <spdlog/spdlog.h>
+#include "AssetWatcher.h"
 #include "Tiled/MapLayer.h"
 #include "Tiled/Texture.h"
 #include "Aseprite/AsepriteObject.h"
 
-#include <SDL_image.h>
+#include <algorithm>
 #include <tmxlite/Layer.hpp>
 #include <tmxlite/TileLayer.hpp>
+#include <tmxlite/Tileset.hpp>
 #include <tmxlite/Map.hpp>
 
+namespace {
+    bool HasSameTilesets(const tmx::Map& a, const tmx::Map& b) {
+        const auto& tileSetsA = a.getTilesets();
+        const auto& tileSetsB = b.getTilesets();
+        if (tileSetsA.size() != tileSetsB.size())
+            return false;
+
+        for (size_t i = 0; i < tileSetsA.size(); i++) {
+            if (tileSetsA[i].getFirstGID() != tileSetsB[i].getFirstGID()
+                || tileSetsA[i].getTileCount() != tileSetsB[i].getTileCount()
+                || tileSetsA[i].getImagePath() != tileSetsB[i].getImagePath())
+                return false;
+        }
+        return true;
+    }
+
+    // Maps with the same size, tile sets and layer types can be re-baked layer by layer
+    bool HasSameLayout(const tmx::Map& a, const tmx::Map& b) {
+        const auto& layersA = a.getLayers();
+        const auto& layersB = b.getLayers();
+        if (a.getTileCount().x != b.getTileCount().x || a.getTileCount().y != b.getTileCount().y
+            || a.getTileSize().x != b.getTileSize().x || a.getTileSize().y != b.getTileSize().y
+            || layersA.size() != layersB.size() || !HasSameTilesets(a, b))
+            return false;
+
+        for (size_t i = 0; i < layersA.size(); i++) {
+            if (layersA[i]->getType() != layersB[i]->getType())
+                return false;
+        }
+        return true;
+    }
+
+    bool HasSameTiles(const tmx::Layer& a, const tmx::Layer& b) {
+        const auto& layerA = a.getLayerAs<tmx::TileLayer>();
+        const auto& layerB = b.getLayerAs<tmx::TileLayer>();
+        const auto& tilesA = layerA.getTiles();
+        const auto& tilesB = layerB.getTiles();
+        if (tilesA.size() != tilesB.size() || !(layerA.getTintColour() == layerB.getTintColour()))
+            return false;
+
+        return std::equal(tilesA.begin(), tilesA.end(), tilesB.begin(),
+                          [](const tmx::TileLayer::Tile& tileA, const tmx::TileLayer::Tile& tileB) {
+                              return tileA.ID == tileB.ID && tileA.flipFlags == tileB.flipFlags;
+                          });
+    }
+}  // namespace
+
 AssetStore::AssetStore() {
     spdlog::info("AssetStore constructor called.");
 }
 
 AssetStore::~AssetStore() {
+    // Stop the worker before the assets go away
+    watcher.reset();
     ClearAssets();
     spdlog::info("AssetStore destructor called.");
 }
@@ -22,45 +73,61 @@ AssetStore::~AssetStore() {
 void AssetStore::ClearAssets() {
     // Loop through all textures
     for (auto& pair : textures) {
-        // Deallocate textures in memory
-        SDL_DestroyTexture(pair.second);  // pair.second - delete the value of "texture"
+        // Give the image back to the cache
+        if (pair.second.image)
+            textureCache.Release(pair.second.filePath);
     }
 
     // Loop through Tiled layers
-    for (auto& [_, val] : tileLayers) { // range-based loop, xx17
-        for (SDL_Texture* texture : val) {
-            SDL_DestroyTexture(texture);
-        }
+    for (auto& [_, tileMap] : tileMaps) { // range-based loop, xx17
+        DestroyTileLayers(tileMap);
     }
 
     // Clear the map
     textures.clear();
     tileMaps.clear();
-    tileLayers.clear();
+    asepriteHandles.clear();
     asepriteObjects.clear();
+    asepriteFiles.clear();
+
+    // Deallocate textures in memory
+    textureCache.Clear();
+
+    // Parsed .tsx files shared between the maps
+    tmx::Tileset::clearCache();
 
     spdlog::info("Textures, tiled and Aseprite objects have been cleared.");
 }
 
 void AssetStore::LoadTexture(SDL_Renderer* renderer, const std::string& assetId,
                             const std::string& filePath) {
-    // Create a texture from a surface
-    SDL_Surface* surface = IMG_Load(filePath.c_str());
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    if (!surface || !texture) {
+    this->renderer = renderer;
+
+    // Decoded once, shared with every other asset using the same file
+    const auto* image = textureCache.Acquire(renderer, filePath);
+    if (!image) {
         spdlog::error("Failed to load image: {}", filePath);
         return;
     }
-    SDL_FreeSurface(surface);
+
+    // Replace the previous texture with the same id
+    auto item = textures.find(assetId);
+    if (item != textures.end() && item->second.image)
+        textureCache.Release(item->second.filePath);
 
     // Add the texture to the map
-    textures.emplace(assetId, texture);  // emplace(key, value)
+    textures[assetId] = { filePath, image, ++useClock };
+    if (watcher)
+        watcher->Watch(filePath);
 
     spdlog::info("New texture added to the Asset Store with id: {}", assetId);
+    EnforceBudget();
 }
 
 void AssetStore::LoadTmxFile(SDL_Renderer* renderer, const std::string& assetId,
-                            const std::string& filePath) {
+                            const std::string& filePath, const std::vector<std::string>& collisionLayers) {
+    this->renderer = renderer;
+
     if (filePath.empty()) {
         spdlog::error("Tileset doesn't exist: {}", filePath);
         return;
@@ -68,63 +135,122 @@ void AssetStore::LoadTmxFile(SDL_Renderer* renderer, const std::string& assetId,
 
     auto map = std::make_shared<tmx::Map>();
     if (map->load(filePath)) {
-        if (tileMaps.count(assetId) > 0U)
-            tileMaps.erase(assetId);
-        if (tileLayers.count(assetId) > 0U)
-            tileLayers.erase(assetId);
+        // Replace the previous map with the same id
+        auto& tileMap = tileMaps[assetId];
+        DestroyTileLayers(tileMap);
 
         // Add to the AssetStore
-        tileMaps[assetId] = map;
-        tileLayers[assetId] = {};  // Initialize vector
+        tileMap.filePath = filePath;
+        tileMap.map = map;
+        tileMap.lastUsed = ++useClock;
+
+        // Solid tiles for the movement
+        if (!tileMap.collisionGrid)
+            tileMap.collisionGrid = std::make_unique<tiled::CollisionGrid>();
+        tileMap.collisionLayers = collisionLayers;
+        tileMap.collisionGrid->Build(*map, collisionLayers);
 
         spdlog::info("Tile map loaded: {}", assetId);
-        // Generate texture
-        std::vector<std::unique_ptr<tiled::Texture>> textures;
-        std::vector<std::unique_ptr<tiled::MapLayer>> renderLayers;
-        // CreateLayerTexture(renderer, assetId);
-        // load the textures as they're shared between layers
-        const auto& tileSets = map->getTilesets();
-        assert(!tileSets.empty());  // todo fix this
-        for (const auto& ts : tileSets) {
-            textures.emplace_back(std::make_unique<tiled::Texture>());
-            if (!textures.back()->loadFromFile(ts.getImagePath(), renderer))
-                spdlog::error("Failed opening: {} ", ts.getImagePath());
-        }
+        if (watcher)
+            watcher->Watch(filePath);
+        BakeTileLayers(tileMap);
+        EnforceBudget();
+    }
+}
 
-        // load the layers
-        const auto& mapLayers = map->getLayers();
-        for (auto i = 0u; i < mapLayers.size(); ++i) {
-            if (mapLayers[i]->getType() == tmx::Layer::Type::Tile) {
-                renderLayers.emplace_back(std::make_unique<tiled::MapLayer>());
-                if (renderLayers.back()->Create(renderer, map, i, textures))
-                    tileLayers[assetId].push_back(renderLayers.back()->GenerateTexture(renderer));
-            }
+std::vector<std::unique_ptr<tiled::Texture>> AssetStore::LoadTilesetTextures(const tmx::Map& map) {
+    // load the textures as they're shared between layers
+    std::vector<std::unique_ptr<tiled::Texture>> textures;
+    for (const auto& ts : map.getTilesets()) {
+        textures.emplace_back(std::make_unique<tiled::Texture>());
+        if (!textures.back()->loadFromFile(ts.getImagePath(), renderer, textureCache))
+            spdlog::error("Failed opening: {} ", ts.getImagePath());
+        if (watcher)
+            watcher->Watch(ts.getImagePath());
+    }
+    return textures;
+}
+
+SDL_Texture* AssetStore::BakeTileLayer(const std::shared_ptr<tmx::Map>& map, std::uint32_t layerIndex,
+                                       const std::vector<std::unique_ptr<tiled::Texture>>& textures) {
+    tiled::MapLayer renderLayer;
+    if (!renderLayer.Create(renderer, map, layerIndex, textures))
+        return nullptr;
+    return renderLayer.GenerateTexture(renderer);
+}
+
+bool AssetStore::BakeTileLayers(TileMapAsset& tileMap) {
+    if (!renderer || !tileMap.map)
+        return false;
+
+    // Generate texture
+    assert(!tileMap.map->getTilesets().empty());  // todo fix this
+    const auto textures = LoadTilesetTextures(*tileMap.map);
+
+    // load the layers
+    const auto& mapLayers = tileMap.map->getLayers();
+    for (auto i = 0u; i < mapLayers.size(); ++i) {
+        if (mapLayers[i]->getType() == tmx::Layer::Type::Tile) {
+            SDL_Texture* texture = BakeTileLayer(tileMap.map, i, textures);
+            tileMap.layers.push_back(texture);
+            tileMap.bytes += TextureCache::GetTextureBytes(texture);
         }
     }
+    tileLayersMemory += tileMap.bytes;
+    return true;
+}
+
+void AssetStore::DestroyTileLayers(TileMapAsset& tileMap) {
+    for (SDL_Texture* texture : tileMap.layers) {
+        SDL_DestroyTexture(texture);
+    }
+    tileMap.layers.clear();
+    tileLayersMemory -= tileMap.bytes;
+    tileMap.bytes = 0;
 }
 
 void AssetStore::LoadAseprite(SDL_Renderer* renderer, const std::string& assetId, const std::string& jsonPath) {
-    auto aseprite = std::make_shared<AsepriteObject>();
-    if (aseprite->Load(jsonPath)) {
-        // Get image path
-        const std::string basePath = jsonPath.substr(0, jsonPath.find_last_of("/\\"));
-        const std::string imagePath = basePath + "/" + aseprite->imageName;
+    AsepriteObject aseprite;
+    if (!aseprite.Load(jsonPath))
+        return;
+
+    // Get image path
+    const std::string basePath = jsonPath.substr(0, jsonPath.find_last_of("/\\"));
+    const std::string imagePath = basePath + "/" + aseprite.imageName;
 
-        // Add data
-        LoadTexture(renderer, assetId, imagePath);
-        asepriteObjects[assetId] = aseprite;
+    // Add data, reloading an asset keeps its handle
+    LoadTexture(renderer, assetId, imagePath);
+    auto item = asepriteHandles.find(assetId);
+    if (item != asepriteHandles.end()) {
+        asepriteObjects[item->second] = std::move(aseprite);
+        asepriteFiles[item->second] = TextureCache::NormalizePath(jsonPath);
+    } else {
+        asepriteHandles.emplace(assetId, static_cast<AsepriteHandle>(asepriteObjects.size()));
+        asepriteObjects.push_back(std::move(aseprite));
+        asepriteFiles.push_back(TextureCache::NormalizePath(jsonPath));
     }
+    if (watcher)
+        watcher->Watch(jsonPath);
 
     spdlog::info("New Aseprite object added to the Asset Store with id: {}", assetId);
 }
 
-std::vector<SDL_Texture*> AssetStore::GetTmxLayers(const std::string& assetId) {
-    auto item = tileLayers.find(assetId);
-    if (item == tileLayers.end()) {
+const std::vector<SDL_Texture*>& AssetStore::GetTmxLayers(const std::string& assetId) {
+    static const std::vector<SDL_Texture*> noLayers;
+
+    auto item = tileMaps.find(assetId);
+    if (item == tileMaps.end()) {
         spdlog::error("Can't find TMX layer with assetId: {}", assetId);
-        return {};
+        return noLayers;
     }
-    return item->second;
+
+    auto& tileMap = item->second;
+    tileMap.lastUsed = ++useClock;
+    if (tileMap.layers.empty() && BakeTileLayers(tileMap)) {
+        spdlog::info("Evicted tile map baked again: {}", assetId);
+        EnforceBudget();
+    }
+    return tileMap.layers;
 }
 
 std::shared_ptr<tmx::Map> AssetStore::GetTmxMap(const std::string& assetId) {
@@ -133,7 +259,17 @@ std::shared_ptr<tmx::Map> AssetStore::GetTmxMap(const std::string& assetId) {
         spdlog::error("Can't find tilemap with assetId: {}", assetId);
         return nullptr;
     }
-    return item->second;
+    item->second.lastUsed = ++useClock;
+    return item->second.map;
+}
+
+tiled::CollisionGrid* AssetStore::GetCollisionGrid(const std::string& assetId) {
+    auto item = tileMaps.find(assetId);
+    if (item == tileMaps.end()) {
+        spdlog::error("Can't find tilemap with assetId: {}", assetId);
+        return nullptr;
+    }
+    return item->second.collisionGrid.get();
 }
 
 SDL_Texture* AssetStore::GetTexture(const std::string& assetId) {
@@ -142,15 +278,234 @@ SDL_Texture* AssetStore::GetTexture(const std::string& assetId) {
         spdlog::error("Can't find texture with assetId: {}", assetId);
         return nullptr;
     }
-    return item->second;
+
+    auto& texture = item->second;
+    texture.lastUsed = ++useClock;
+    if (!texture.image) {
+        texture.image = textureCache.Acquire(renderer, texture.filePath);
+        if (!texture.image)
+            return nullptr;
+        spdlog::info("Evicted texture loaded again: {}", assetId);
+        EnforceBudget();
+    }
+    return texture.image->texture;
 }
 
-std::shared_ptr<AsepriteObject> AssetStore::GetAsepriteObject(const std::string& assetId)  {
-    auto item = asepriteObjects.find(assetId);
-    if (item == asepriteObjects.end()) {
+AsepriteHandle AssetStore::GetAsepriteHandle(const std::string& assetId) const {
+    auto item = asepriteHandles.find(assetId);
+    if (item == asepriteHandles.end()) {
         spdlog::error("Can't find Aseprite object with assetId: {}", assetId);
-        return nullptr;
+        return INVALID_ASEPRITE_HANDLE;
     }
     return item->second;
 }
 
+void AssetStore::RetainAsset(const std::string& assetId) {
+    assetReferences[assetId]++;
+}
+
+void AssetStore::ReleaseAsset(const std::string& assetId) {
+    auto item = assetReferences.find(assetId);
+    if (item == assetReferences.end())
+        return;
+    if (--item->second <= 0)
+        assetReferences.erase(item);
+}
+
+bool AssetStore::IsReferenced(const std::string& assetId) const {
+    return assetReferences.find(assetId) != assetReferences.end();
+}
+
+void AssetStore::SetTextureBudget(std::size_t bytes) {
+    textureBudget = bytes;
+    EnforceBudget();
+}
+
+std::size_t AssetStore::GetTextureMemory() const {
+    return textureCache.GetMemory() + tileLayersMemory;
+}
+
+void AssetStore::ReleaseUnusedAssets() {
+    EvictUnused(GetTextureMemory());
+}
+
+void AssetStore::EnforceBudget() {
+    const std::size_t memory = GetTextureMemory();
+    if (textureBudget == 0 || memory <= textureBudget)
+        return;
+
+    EvictUnused(memory - textureBudget);
+    if (GetTextureMemory() > textureBudget) {
+        spdlog::warn("Texture memory {} exceeds the budget {}, the rest is in use",
+                     GetTextureMemory(), textureBudget);
+    }
+}
+
+void AssetStore::EvictUnused(std::size_t bytes) {
+    // Images no asset holds anymore (e.g. tile sets after baking) are the cheapest to lose
+    std::size_t freed = textureCache.EvictUnused(bytes);
+    if (freed >= bytes)
+        return;
+
+    // Then the assets no entity uses, least recently used first
+    struct Candidate {
+        std::uint64_t lastUsed;
+        TextureAsset* texture;
+        TileMapAsset* tileMap;
+    };
+    std::vector<Candidate> candidates;
+    for (auto& [assetId, texture] : textures) {
+        if (texture.image && !IsReferenced(assetId))
+            candidates.push_back({ texture.lastUsed, &texture, nullptr });
+    }
+    for (auto& [assetId, tileMap] : tileMaps) {
+        if (!tileMap.layers.empty() && !IsReferenced(assetId))
+            candidates.push_back({ tileMap.lastUsed, nullptr, &tileMap });
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.lastUsed < b.lastUsed; });
+
+    for (auto& candidate : candidates) {
+        if (freed >= bytes)
+            break;
+
+        // Never evict the asset that is being returned right now
+        if (candidate.lastUsed == useClock)
+            continue;
+
+        const std::size_t memory = GetTextureMemory();
+        if (candidate.texture) {
+            // The image is destroyed only if no other asset shares it
+            textureCache.Release(candidate.texture->filePath);
+            textureCache.Evict(candidate.texture->filePath);
+            candidate.texture->image = nullptr;
+        } else {
+            DestroyTileLayers(*candidate.tileMap);
+        }
+        freed += memory - GetTextureMemory();
+    }
+
+    // Tile sets of the evicted maps
+    if (freed < bytes)
+        textureCache.EvictUnused(bytes - freed);
+}
+
+void AssetStore::EnableHotReload() {
+    if (watcher)
+        return;
+
+    watcher = std::make_unique<AssetWatcher>();
+    if (!watcher->Start()) {
+        watcher.reset();
+        return;
+    }
+
+    // Watch the assets loaded so far
+    for (const auto& [_, texture] : textures)
+        watcher->Watch(texture.filePath);
+    for (const auto& [_, tileMap] : tileMaps) {
+        watcher->Watch(tileMap.filePath);
+        for (const auto& ts : tileMap.map->getTilesets())
+            watcher->Watch(ts.getImagePath());
+    }
+    for (const auto& jsonPath : asepriteFiles)
+        watcher->Watch(jsonPath);
+}
+
+void AssetStore::Update() {
+    if (!watcher)
+        return;
+
+    // Swap the assets reloaded by the worker, the frame never waits for a file
+    for (auto& reload : watcher->TakeReloads()) {
+        if (reload.map)
+            ReloadTileMap(reload.filePath, reload.map);
+        else if (reload.aseprite)
+            ReloadAseprite(reload.filePath, std::move(*reload.aseprite));
+        else if (reload.image.pixels)
+            ReloadImage(reload.filePath, reload.image);
+    }
+}
+
+void AssetStore::ReloadImage(const std::string& filePath, const TextureCache::Image& image) {
+    // Evicted images will be read from the new file anyway
+    if (!textureCache.Contains(filePath) || !textureCache.Reload(renderer, filePath, image))
+        return;
+
+    // Re-bake the maps using the image as a tile set
+    for (auto& [assetId, tileMap] : tileMaps) {
+        if (tileMap.layers.empty())
+            continue;
+
+        const auto& tileSets = tileMap.map->getTilesets();
+        const bool isUsed = std::any_of(tileSets.begin(), tileSets.end(), [&](const auto& ts) {
+            return TextureCache::NormalizePath(ts.getImagePath()) == filePath;
+        });
+        if (isUsed) {
+            DestroyTileLayers(tileMap);
+            BakeTileLayers(tileMap);
+            spdlog::info("Tile map baked again: {}", assetId);
+        }
+    }
+    EnforceBudget();
+}
+
+void AssetStore::ReloadTileMap(const std::string& filePath, const std::shared_ptr<tmx::Map>& map) {
+    for (auto& [assetId, tileMap] : tileMaps) {
+        if (TextureCache::NormalizePath(tileMap.filePath) != filePath)
+            continue;
+
+        const auto previous = tileMap.map;
+        tileMap.map = map;
+        if (tileMap.collisionGrid)
+            tileMap.collisionGrid->Build(*map, tileMap.collisionLayers);
+
+        // Evicted maps are baked on the next use
+        if (tileMap.layers.empty())
+            continue;
+
+        if (!HasSameLayout(*previous, *map)) {
+            DestroyTileLayers(tileMap);
+            BakeTileLayers(tileMap);
+            spdlog::info("Tile map baked again: {}", assetId);
+            continue;
+        }
+
+        // Re-bake only the changed layers
+        const auto& previousLayers = previous->getLayers();
+        const auto& mapLayers = map->getLayers();
+        std::vector<std::unique_ptr<tiled::Texture>> textures;
+        size_t tileLayerIndex = 0;
+        for (auto i = 0u; i < mapLayers.size(); ++i) {
+            if (mapLayers[i]->getType() != tmx::Layer::Type::Tile)
+                continue;
+
+            if (!HasSameTiles(*previousLayers[i], *mapLayers[i])) {
+                if (textures.empty())
+                    textures = LoadTilesetTextures(*map);
+
+                SDL_Texture*& texture = tileMap.layers[tileLayerIndex];
+                const std::size_t bytes = TextureCache::GetTextureBytes(texture);
+                SDL_DestroyTexture(texture);
+                texture = BakeTileLayer(map, i, textures);
+
+                tileMap.bytes = tileMap.bytes - bytes + TextureCache::GetTextureBytes(texture);
+                tileLayersMemory = tileLayersMemory - bytes + TextureCache::GetTextureBytes(texture);
+                spdlog::info("Tile layer {} of {} baked again", mapLayers[i]->getName(), assetId);
+            }
+            tileLayerIndex++;
+        }
+    }
+    EnforceBudget();
+}
+
+void AssetStore::ReloadAseprite(const std::string& filePath, AsepriteObject&& aseprite) {
+    for (size_t handle = 0; handle < asepriteFiles.size(); handle++) {
+        if (asepriteFiles[handle] == filePath) {
+            // The handle stays the same, so the animated entities pick the new data up
+            asepriteObjects[handle] = std::move(aseprite);
+            spdlog::info("Aseprite object reloaded: {}", filePath);
+            return;
+        }
+    }
+}
@@ -1,22 +1,74 @@
 #ifndef ASSETSTORE_H
 #define ASSETSTORE_H
 
+#include "Aseprite/AsepriteObject.h"
+#include "TextureCache.h"
+#include "Tiled/CollisionGrid.h"
+
 #include <SDL.h>
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // Forward declaration
-struct AsepriteObject;
+class AssetWatcher;
+namespace tiled {
+    class Texture;
+}
 namespace tmx {
     class Map;
 }
 
 class AssetStore {
+    // Texture asset, the image itself is owned by `textureCache`
+    struct TextureAsset {
+        std::string filePath;
+        const TextureCache::Entry* image = nullptr;  // nullptr when evicted
+        std::uint64_t lastUsed = 0;
+    };
+
+    // Tiled map asset, the layers are baked into one texture each
+    struct TileMapAsset {
+        std::string filePath;
+        std::shared_ptr<tmx::Map> map;
+        std::vector<SDL_Texture*> layers;  // empty when evicted
+        std::size_t bytes = 0;             // GPU memory of the baked layers
+        std::uint64_t lastUsed = 0;
+
+        // Built at load time, kept at the same address across reloads and evictions
+        std::unique_ptr<tiled::CollisionGrid> collisionGrid;
+        std::vector<std::string> collisionLayers;
+    };
+
+    // Decoded images shared by textures, Tiled maps and Aseprite objects
+    TextureCache textureCache;
+
     // The list of textures
-    std::map<std::string, SDL_Texture*> textures;
-    std::map<std::string, std::shared_ptr<tmx::Map>> tileMaps;
-    std::map<std::string, std::vector<SDL_Texture*>> tileLayers;
-    std::map<std::string, std::shared_ptr<AsepriteObject>> asepriteObjects;
+    std::map<std::string, TextureAsset> textures;
+    std::map<std::string, TileMapAsset> tileMaps;
+    std::map<std::string, AsepriteHandle> asepriteHandles;
+    std::vector<AsepriteObject> asepriteObjects;  // [ index = AsepriteHandle ]
+    std::vector<std::string> asepriteFiles;       // [ index = AsepriteHandle ]
+
+    // Number of entities using an asset [ key = assetId ], referenced assets are never evicted
+    std::unordered_map<std::string, int> assetReferences;
+
+    // Texture memory ceiling in bytes, 0 means no limit
+    std::size_t textureBudget = 0;
+    std::size_t tileLayersMemory = 0;
+
+    // Increases on every asset access, gives the LRU order
+    std::uint64_t useClock = 0;
+
+    // Evicted assets are reloaded with the last renderer used for loading
+    SDL_Renderer* renderer = nullptr;
+
+    // Optional file watcher, reloads changed assets on a worker thread
+    std::unique_ptr<AssetWatcher> watcher;
 
     // TODO: map for fonts
     // TODO: map for audio
@@ -27,20 +79,59 @@ public:
 
     // Load assets
     void LoadTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
-    void LoadTmxFile(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
+    void LoadTmxFile(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath,
+                     const std::vector<std::string>& collisionLayers = {});
     void LoadAseprite(SDL_Renderer* renderer, const std::string& assetId, const std::string& jsonPath);
 
-    // Get assets
+    // Get assets, evicted assets are reloaded transparently
     SDL_Texture* GetTexture(const std::string& assetId);
-    std::vector<SDL_Texture*> GetTmxLayers(const std::string& assetId);
+    const std::vector<SDL_Texture*>& GetTmxLayers(const std::string& assetId);
     std::shared_ptr<tmx::Map> GetTmxMap(const std::string& assetId);
-    std::shared_ptr<AsepriteObject> GetAsepriteObject(const std::string& assetId);
+    tiled::CollisionGrid* GetCollisionGrid(const std::string& assetId);
+    AsepriteHandle GetAsepriteHandle(const std::string& assetId) const;
+
+    // Called for every animated entity each frame, keep it inline
+    const AsepriteObject* GetAsepriteObject(AsepriteHandle handle) const {
+        return handle < asepriteObjects.size() ? &asepriteObjects[handle] : nullptr;
+    }
+
+    // Entity usage of an asset
+    void RetainAsset(const std::string& assetId);
+    void ReleaseAsset(const std::string& assetId);
+
+    // Memory management
+    void SetTextureBudget(std::size_t bytes);
+    std::size_t GetTextureMemory() const;
+
+    // Evicts every asset no entity uses, e.g. between levels
+    void ReleaseUnusedAssets();
 
+    // Hot reload of the changed asset files, Linux only
+    void EnableHotReload();
+
+    // Applies the reloaded assets, must be called at a frame boundary
+    void Update();
 
 private:
     void ClearAssets();
-};
 
+    std::vector<std::unique_ptr<tiled::Texture>> LoadTilesetTextures(const tmx::Map& map);
+    SDL_Texture* BakeTileLayer(const std::shared_ptr<tmx::Map>& map, std::uint32_t layerIndex,
+                               const std::vector<std::unique_ptr<tiled::Texture>>& textures);
+    bool BakeTileLayers(TileMapAsset& tileMap);
+    void DestroyTileLayers(TileMapAsset& tileMap);
+    bool IsReferenced(const std::string& assetId) const;
+
+    // Evicts unreferenced assets, least recently used first, until `bytes` have been freed
+    void EvictUnused(std::size_t bytes);
 
+    // Keeps the texture memory under the budget
+    void EnforceBudget();
+
+    // Hot reload
+    void ReloadImage(const std::string& filePath, const TextureCache::Image& image);
+    void ReloadTileMap(const std::string& filePath, const std::shared_ptr<tmx::Map>& map);
+    void ReloadAseprite(const std::string& filePath, AsepriteObject&& aseprite);
+};
 
-#endif //ASSETSTORE_H
+#endif  // ASSETSTORE_H
@@ -0,0 +1,174 @@
+#include "AssetWatcher.h"
+
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <filesystem>
+#include <tmxlite/Map.hpp>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    // The worker wakes up this often to check if it should stop
+    constexpr int POLL_TIMEOUT_MS = 100;
+
+    // Editors save in several writes, wait for them to settle before reading the file
+    constexpr auto SETTLE_TIME = std::chrono::milliseconds(50);
+
+    std::string GetExtension(const std::string& filePath) {
+        return std::filesystem::path(filePath).extension().string();
+    }
+}  // namespace
+
+AssetWatcher::AssetWatcher() {
+}
+
+AssetWatcher::~AssetWatcher() {
+    Stop();
+}
+
+bool AssetWatcher::Start() {
+#ifdef __linux__
+    if (isRunning)
+        return true;
+
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        spdlog::error("Failed to initialize inotify, asset hot reload is disabled.");
+        return false;
+    }
+
+    isRunning = true;
+    worker = std::thread(&AssetWatcher::Run, this);
+    spdlog::info("Asset hot reload enabled.");
+    return true;
+#else
+    spdlog::warn("Asset hot reload is only supported on Linux.");
+    return false;
+#endif
+}
+
+void AssetWatcher::Stop() {
+    if (!isRunning)
+        return;
+
+    isRunning = false;
+    if (worker.joinable())
+        worker.join();
+
+#ifdef __linux__
+    close(inotifyFd);
+#endif
+    inotifyFd = -1;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    watchedDirectories.clear();
+    watchedFiles.clear();
+}
+
+void AssetWatcher::Watch(const std::string& filePath) {
+#ifdef __linux__
+    if (!isRunning)
+        return;
+
+    const std::string file = TextureCache::NormalizePath(filePath);
+    std::string directory = std::filesystem::path(file).parent_path().generic_string();
+    if (directory.empty())
+        directory = ".";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!watchedFiles.insert(file).second)
+        return;
+
+    // One watch per directory, inotify returns the same descriptor for a directory watched twice
+    const int watch = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0) {
+        spdlog::warn("Can't watch the asset directory: {}", directory);
+        return;
+    }
+    watchedDirectories[watch] = directory;
+#endif
+}
+
+std::vector<AssetWatcher::Reload> AssetWatcher::TakeReloads() {
+    std::vector<Reload> result;
+    std::lock_guard<std::mutex> lock(mutex);
+    result.swap(reloads);
+    return result;
+}
+
+void AssetWatcher::Run() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    std::unordered_set<std::string> changedFiles;
+
+    while (isRunning) {
+        pollfd fd = { inotifyFd, POLLIN, 0 };
+        if (poll(&fd, 1, POLL_TIMEOUT_MS) <= 0)
+            continue;
+
+        // Collect the changes, several events for the same file are merged
+        std::this_thread::sleep_for(SETTLE_TIME);
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (char* ptr = buffer; ptr < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                auto directory = watchedDirectories.find(event->wd);
+                if (event->len == 0 || directory == watchedDirectories.end())
+                    continue;
+
+                const std::string file = TextureCache::NormalizePath(directory->second + "/"
+                                                                     + event->name);
+                if (watchedFiles.count(file) > 0U)
+                    changedFiles.insert(file);
+
+                // Tilesets aren't loaded directly, parse the maps of the same folder again
+                if (GetExtension(file) == ".tsx") {
+                    for (const auto& watchedFile : watchedFiles) {
+                        if (GetExtension(watchedFile) == ".tmx"
+                            && watchedFile.compare(0, directory->second.size(), directory->second) == 0)
+                            changedFiles.insert(watchedFile);
+                    }
+                }
+            }
+        }
+
+        // Load outside the lock, the main thread only waits for the result swap
+        for (const auto& file : changedFiles) {
+            Reload reload = Load(file);
+            std::lock_guard<std::mutex> lock(mutex);
+            reloads.push_back(std::move(reload));
+        }
+        changedFiles.clear();
+    }
+#endif
+}
+
+AssetWatcher::Reload AssetWatcher::Load(const std::string& filePath) {
+    spdlog::info("Asset changed on disk: {}", filePath);
+
+    Reload reload;
+    reload.filePath = filePath;
+
+    const std::string extension = GetExtension(filePath);
+    if (extension == ".tmx") {
+        // The editor may still be writing the file, a mapped file truncated mid parse raises SIGBUS
+        auto map = std::make_shared<tmx::Map>();
+        map->setFileMapping(false);
+        if (map->load(filePath))
+            reload.map = map;
+    } else if (extension == ".json") {
+        auto aseprite = std::make_unique<AsepriteObject>();
+        if (aseprite->Load(filePath))
+            reload.aseprite = std::move(aseprite);
+    } else {
+        reload.image = TextureCache::DecodeImage(filePath);
+    }
+    return reload;
+}
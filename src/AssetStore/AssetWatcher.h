@@ -0,0 +1,63 @@
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+
+#include "Aseprite/AsepriteObject.h"
+#include "TextureCache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Forward declaration
+namespace tmx {
+    class Map;
+}
+
+// Watches the loaded asset files (inotify on Linux) and reloads the changed ones on a worker thread.
+// The results are picked up by the AssetStore at a frame boundary.
+class AssetWatcher {
+public:
+    // A changed file loaded on the worker thread, only the field matching the file type is set
+    struct Reload {
+        std::string filePath;  // normalized
+        TextureCache::Image image;                   // .png
+        std::shared_ptr<tmx::Map> map;               // .tmx
+        std::unique_ptr<AsepriteObject> aseprite;    // .json
+    };
+
+    AssetWatcher();
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+    // Returns false if file watching isn't supported on this platform
+    bool Start();
+    void Stop();
+
+    // Thread safe, watches the file directory
+    void Watch(const std::string& filePath);
+
+    // Moves the finished reloads out, the lock is held only for the swap
+    std::vector<Reload> TakeReloads();
+
+private:
+    void Run();
+    static Reload Load(const std::string& filePath);
+
+    int inotifyFd = -1;
+    std::thread worker;
+    std::atomic<bool> isRunning{ false };
+
+    std::mutex mutex;
+    std::unordered_map<int, std::string> watchedDirectories;  // [ key = watch descriptor ]
+    std::unordered_set<std::string> watchedFiles;
+    std::vector<Reload> reloads;
+};
+
+#endif  // ASSETWATCHER_H
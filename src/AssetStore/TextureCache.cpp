@@ -0,0 +1,176 @@
+#include "TextureCache.h"
+
+#include <spdlog/spdlog.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb/stb_image.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+namespace {
+    // Uploads decoded RGBA pixels
+    SDL_Texture* UploadImage(SDL_Renderer* renderer, const TextureCache::Image& image,
+                             const std::string& filePath) {
+        SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+            image.pixels.get(), image.width, image.height, 32, image.width * 4,
+            SDL_PIXELFORMAT_RGBA32);
+        if (!surface) {
+            spdlog::error("Unable to create texture surface: {}", filePath);
+            return nullptr;
+        }
+
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+        SDL_FreeSurface(surface);
+
+        if (!texture)
+            spdlog::error("Failed to create texture: {}", filePath);
+        return texture;
+    }
+}  // namespace
+
+TextureCache::~TextureCache() {
+    Clear();
+}
+
+const TextureCache::Entry* TextureCache::Acquire(SDL_Renderer* renderer, const std::string& filePath) {
+    const std::string key = NormalizePath(filePath);
+
+    auto item = entries.find(key);
+    if (item == entries.end()) {
+        if (!renderer)
+            return nullptr;
+
+        const Image image = DecodeImage(key);
+        if (!image.pixels)
+            return nullptr;
+
+        Entry entry;
+        entry.texture = UploadImage(renderer, image, key);
+        if (!entry.texture)
+            return nullptr;
+        entry.width = image.width;
+        entry.height = image.height;
+
+        entry.bytes = GetTextureBytes(entry.texture);
+        memory += entry.bytes;
+
+        item = entries.emplace(key, entry).first;
+        spdlog::info("Image decoded and added to the texture cache: {}", key);
+    }
+
+    item->second.refCount++;
+    item->second.lastUsed = ++useClock;
+    return &item->second;
+}
+
+bool TextureCache::Reload(SDL_Renderer* renderer, const std::string& filePath, const Image& image) {
+    auto item = entries.find(NormalizePath(filePath));
+    if (item == entries.end() || !image.pixels)
+        return false;
+
+    SDL_Texture* texture = UploadImage(renderer, image, item->first);
+    if (!texture)
+        return false;
+
+    // Swap the texture in place, the entry address doesn't change
+    auto& entry = item->second;
+    SDL_DestroyTexture(entry.texture);
+    memory -= entry.bytes;
+    entry.texture = texture;
+    entry.width = image.width;
+    entry.height = image.height;
+    entry.bytes = GetTextureBytes(texture);
+    memory += entry.bytes;
+
+    spdlog::info("Image reloaded in the texture cache: {}", item->first);
+    return true;
+}
+
+bool TextureCache::Contains(const std::string& filePath) const {
+    return entries.find(NormalizePath(filePath)) != entries.end();
+}
+
+void TextureCache::Release(const std::string& filePath) {
+    auto item = entries.find(NormalizePath(filePath));
+    if (item != entries.end() && item->second.refCount > 0)
+        item->second.refCount--;
+}
+
+void TextureCache::ReleaseUnused() {
+    for (auto item = entries.begin(); item != entries.end();) {
+        if (item->second.refCount == 0) {
+            SDL_DestroyTexture(item->second.texture);
+            memory -= item->second.bytes;
+            item = entries.erase(item);
+        } else {
+            ++item;
+        }
+    }
+}
+
+void TextureCache::Clear() {
+    for (auto& [_, entry] : entries)
+        SDL_DestroyTexture(entry.texture);
+    entries.clear();
+    memory = 0;
+}
+
+std::size_t TextureCache::EvictUnused(std::size_t bytes) {
+    // Collect the candidates, the cache is small so sorting them is cheap
+    std::vector<std::pair<std::uint64_t, std::unordered_map<std::string, Entry>::iterator>> unused;
+    for (auto item = entries.begin(); item != entries.end(); ++item) {
+        if (item->second.refCount == 0)
+            unused.emplace_back(item->second.lastUsed, item);
+    }
+    std::sort(unused.begin(), unused.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::size_t freed = 0;
+    for (auto& [_, item] : unused) {
+        if (freed >= bytes)
+            break;
+        spdlog::info("Texture evicted from the cache: {}", item->first);
+        SDL_DestroyTexture(item->second.texture);
+        freed += item->second.bytes;
+        memory -= item->second.bytes;
+        entries.erase(item);
+    }
+    return freed;
+}
+
+void TextureCache::Evict(const std::string& filePath) {
+    auto item = entries.find(NormalizePath(filePath));
+    if (item == entries.end() || item->second.refCount > 0)
+        return;
+
+    SDL_DestroyTexture(item->second.texture);
+    memory -= item->second.bytes;
+    entries.erase(item);
+}
+
+std::size_t TextureCache::GetTextureBytes(SDL_Texture* texture) {
+    Uint32 format = 0;
+    int width = 0;
+    int height = 0;
+    if (!texture || SDL_QueryTexture(texture, &format, nullptr, &width, &height) != 0)
+        return 0;
+    return static_cast<std::size_t>(width) * height * SDL_BYTESPERPIXEL(format);
+}
+
+TextureCache::Image TextureCache::DecodeImage(const std::string& filePath) {
+    Image image;
+    int channels = 0;
+    unsigned char* data = stbi_load(filePath.c_str(), &image.width, &image.height, &channels,
+                                    STBI_rgb_alpha);
+    if (!data) {
+        spdlog::error("Failed to load image: {}", filePath);
+        return image;
+    }
+    image.pixels = std::shared_ptr<unsigned char>(data, stbi_image_free);
+    return image;
+}
+
+std::string TextureCache::NormalizePath(const std::string& filePath) {
+    return std::filesystem::path(filePath).lexically_normal().generic_string();
+}
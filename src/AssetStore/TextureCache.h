@@ -0,0 +1,84 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Path-keyed cache of decoded and uploaded images.
+// Every image file is decoded and uploaded to the GPU once, no matter how many
+// textures, tile maps or Aseprite objects reference it.
+class TextureCache {
+public:
+    struct Entry {
+        SDL_Texture* texture = nullptr;
+        int width = 0;
+        int height = 0;
+        int refCount = 0;
+        std::size_t bytes = 0;        // GPU memory of the texture
+        std::uint64_t lastUsed = 0;   // value of the use clock at the last `Acquire()`
+    };
+
+    // Decoded RGBA pixels, can be produced on any thread
+    struct Image {
+        std::shared_ptr<unsigned char> pixels;
+        int width = 0;
+        int height = 0;
+    };
+
+    TextureCache() = default;
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // Returns the cached image and increases its ref count, decodes and uploads the file
+    // on the first request. The pointer stays valid until the entry is destroyed.
+    const Entry* Acquire(SDL_Renderer* renderer, const std::string& filePath);
+
+    // Uploads a new version of a cached image. The entry keeps its address,
+    // so every holder sees the new texture. Must be called on the render thread
+    bool Reload(SDL_Renderer* renderer, const std::string& filePath, const Image& image);
+
+    bool Contains(const std::string& filePath) const;
+
+    // Decreases the ref count, the texture stays cached until `ReleaseUnused()`
+    void Release(const std::string& filePath);
+
+    // Destroys the textures nobody holds anymore
+    void ReleaseUnused();
+
+    // Destroys all the textures
+    void Clear();
+
+    // Destroys unreferenced textures, least recently used first, until `bytes` have been freed.
+    // Returns the amount of freed memory
+    std::size_t EvictUnused(std::size_t bytes);
+
+    // Destroys the texture of the file if nobody holds it
+    void Evict(const std::string& filePath);
+
+    // Memory of all the cached textures, bytes
+    std::size_t GetMemory() const {
+        return memory;
+    }
+
+    // width * height * bytes per pixel of the texture format
+    static std::size_t GetTextureBytes(SDL_Texture* texture);
+
+    // Decodes an image file, thread safe
+    static Image DecodeImage(const std::string& filePath);
+
+    // Turns "a/b/../c.png" and "a/c.png" into the same cache key
+    static std::string NormalizePath(const std::string& filePath);
+
+private:
+    std::unordered_map<std::string, Entry> entries;
+    std::size_t memory = 0;
+    std::uint64_t useClock = 0;
+};
+
+#endif  // TEXTURECACHE_H
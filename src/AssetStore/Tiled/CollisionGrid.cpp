@@ -0,0 +1,261 @@
+#include "CollisionGrid.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <tmxlite/Map.hpp>
+#include <tmxlite/TileLayer.hpp>
+
+using namespace tiled;
+
+namespace {
+    // Fraction of a tile ignored at the box edges, keeps a box resting flush against
+    // a solid tile from counting as inside it because of float rounding
+    constexpr float EDGE_EPSILON = 1e-4f;
+
+    bool HasCollisionProperty(const std::vector<tmx::Property>& properties) {
+        for (const auto& property : properties) {
+            if (property.getName() == "collision" && property.getType() == tmx::Property::Type::Boolean)
+                return property.getBoolValue();
+        }
+        return false;
+    }
+}  // namespace
+
+CollisionGrid::CollisionGrid()
+    : m_width(0)
+    , m_height(0)
+    , m_wordsPerRow(0)
+    , m_tileSize(0.0f, 0.0f)
+    , m_origin(0.0f, 0.0f)
+    , m_cellSize(0.0f, 0.0f)
+    , m_scale(1.0f, 1.0f)
+    , m_version(0) {
+}
+
+bool CollisionGrid::Build(const tmx::Map& map, const std::vector<std::string>& collisionLayers) {
+    if (map.isInfinite()) {
+        spdlog::error("Collision grid can't be built from an infinite map");
+        return false;
+    }
+
+    m_width = static_cast<int>(map.getTileCount().x);
+    m_height = static_cast<int>(map.getTileCount().y);
+    m_wordsPerRow = (m_width + 63) / 64;
+    m_bits.assign(static_cast<size_t>(m_wordsPerRow) * m_height, 0);
+    m_tileSize = glm::vec2(map.getTileSize().x, map.getTileSize().y);
+    m_cellSize = m_tileSize * m_scale;
+
+    // Tiles marked as solid in their tile set [ index = GID ]
+    std::vector<bool> solidTiles;
+    for (const auto& tileset : map.getTilesets()) {
+        for (const auto& tile : tileset.getTiles()) {
+            if (!HasCollisionProperty(tile.properties))
+                continue;
+            const std::uint32_t gid = tileset.getFirstGID() + tile.ID;
+            if (gid >= solidTiles.size())
+                solidTiles.resize(gid + 1, false);
+            solidTiles[gid] = true;
+        }
+    }
+
+    const size_t tileCount = static_cast<size_t>(m_width) * m_height;
+    for (const auto& layer : map.getLayers()) {
+        if (layer->getType() != tmx::Layer::Type::Tile)
+            continue;
+
+        const bool solidLayer =
+            HasCollisionProperty(layer->getProperties()) ||
+            std::find(collisionLayers.begin(), collisionLayers.end(), layer->getName()) != collisionLayers.end();
+        if (!solidLayer && solidTiles.empty())
+            continue;
+
+        const auto& tiles = layer->getLayerAs<tmx::TileLayer>().getTiles();
+        const size_t count = std::min(tiles.size(), tileCount);
+        for (size_t i = 0; i < count; i++) {
+            const std::uint32_t id = tiles[i].ID;
+            if (id == 0 || !(solidLayer || (id < solidTiles.size() && solidTiles[id])))
+                continue;
+
+            const int column = static_cast<int>(i % m_width);
+            const int row = static_cast<int>(i / m_width);
+            m_bits[row * m_wordsPerRow + (column >> 6)] |= std::uint64_t(1) << (column & 63);
+        }
+    }
+
+    size_t solidCount = 0;
+    for (const auto word : m_bits)
+        solidCount += std::bitset<64>(word).count();
+
+    m_version++;
+    spdlog::info("Collision grid built: {}x{} tiles, {} solid", m_width, m_height, solidCount);
+    return true;
+}
+
+void CollisionGrid::SetWorldTransform(glm::vec2 position, glm::vec2 scale) {
+    m_origin = position;
+    m_scale = scale;
+    m_cellSize = m_tileSize * m_scale;
+    m_version++;
+}
+
+void CollisionGrid::SetSolid(int column, int row, bool solid) {
+    if (column < 0 || row < 0 || column >= m_width || row >= m_height)
+        return;
+
+    std::uint64_t& word = m_bits[row * m_wordsPerRow + (column >> 6)];
+    const std::uint64_t bit = std::uint64_t(1) << (column & 63);
+    if (((word & bit) != 0) == solid)
+        return;
+
+    word ^= bit;
+    m_version++;
+}
+
+glm::ivec2 CollisionGrid::WorldToCell(glm::vec2 worldPosition) const {
+    if (m_cellSize.x <= 0.0f || m_cellSize.y <= 0.0f)
+        return glm::ivec2(0, 0);
+
+    const glm::vec2 local = (worldPosition - m_origin) / m_cellSize;
+    return glm::ivec2(static_cast<int>(std::floor(local.x)), static_cast<int>(std::floor(local.y)));
+}
+
+bool CollisionGrid::IsSolidAt(glm::vec2 worldPosition) const {
+    if (m_cellSize.x <= 0.0f || m_cellSize.y <= 0.0f)
+        return false;
+
+    const glm::ivec2 cell = WorldToCell(worldPosition);
+    return IsSolid(cell.x, cell.y);
+}
+
+bool CollisionGrid::IsAreaSolid(int firstColumn, int firstRow, int lastColumn, int lastRow) const {
+    if (firstColumn > lastColumn || firstRow > lastRow)
+        return false;
+    if (firstColumn < 0 || firstRow < 0 || lastColumn >= m_width || lastRow >= m_height)
+        return true;
+
+    const int firstWord = firstColumn >> 6;
+    const int lastWord = lastColumn >> 6;
+    const std::uint64_t firstMask = ~std::uint64_t(0) << (firstColumn & 63);
+    const std::uint64_t lastMask = ~std::uint64_t(0) >> (63 - (lastColumn & 63));
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        const std::uint64_t* words = &m_bits[row * m_wordsPerRow];
+        if (firstWord == lastWord) {
+            if (words[firstWord] & firstMask & lastMask)
+                return true;
+            continue;
+        }
+
+        if (words[firstWord] & firstMask)
+            return true;
+        for (int word = firstWord + 1; word < lastWord; word++) {
+            if (words[word])
+                return true;
+        }
+        if (words[lastWord] & lastMask)
+            return true;
+    }
+    return false;
+}
+
+bool CollisionGrid::Overlaps(glm::vec2 position, glm::vec2 size) const {
+    if (m_cellSize.x <= 0.0f || m_cellSize.y <= 0.0f)
+        return false;
+
+    const glm::vec2 local = position - m_origin;
+    return IsAreaSolid(FirstCell(local.x, m_cellSize.x), FirstCell(local.y, m_cellSize.y),
+                       LastCell(local.x + size.x, m_cellSize.x), LastCell(local.y + size.y, m_cellSize.y));
+}
+
+glm::vec2 CollisionGrid::Move(glm::vec2 position, glm::vec2 size, glm::vec2 delta, bool* hitX,
+                              bool* hitY) const {
+    if (hitX)
+        *hitX = false;
+    if (hitY)
+        *hitY = false;
+    if (m_cellSize.x <= 0.0f || m_cellSize.y <= 0.0f)
+        return position + delta;
+
+    glm::vec2 local = position - m_origin;
+
+    // Horizontal sweep: only the columns the leading edge enters are tested
+    if (delta.x != 0.0f) {
+        const int firstRow = FirstCell(local.y, m_cellSize.y);
+        const int lastRow = LastCell(local.y + size.y, m_cellSize.y);
+        bool hit = false;
+        if (delta.x > 0.0f) {
+            const int from = LastCell(local.x + size.x, m_cellSize.x) + 1;
+            const int to = LastCell(local.x + size.x + delta.x, m_cellSize.x);
+            if (from <= to && IsAreaSolid(from, firstRow, to, lastRow)) {
+                for (int column = from; column <= to && !hit; column++) {
+                    if (IsAreaSolid(column, firstRow, column, lastRow)) {
+                        local.x = column * m_cellSize.x - size.x;
+                        hit = true;
+                    }
+                }
+            }
+        } else {
+            const int from = FirstCell(local.x, m_cellSize.x) - 1;
+            const int to = FirstCell(local.x + delta.x, m_cellSize.x);
+            if (to <= from && IsAreaSolid(to, firstRow, from, lastRow)) {
+                for (int column = from; column >= to && !hit; column--) {
+                    if (IsAreaSolid(column, firstRow, column, lastRow)) {
+                        local.x = (column + 1) * m_cellSize.x;
+                        hit = true;
+                    }
+                }
+            }
+        }
+        if (!hit)
+            local.x += delta.x;
+        if (hitX)
+            *hitX = hit;
+    }
+
+    // Vertical sweep with the resolved horizontal position
+    if (delta.y != 0.0f) {
+        const int firstColumn = FirstCell(local.x, m_cellSize.x);
+        const int lastColumn = LastCell(local.x + size.x, m_cellSize.x);
+        bool hit = false;
+        if (delta.y > 0.0f) {
+            const int from = LastCell(local.y + size.y, m_cellSize.y) + 1;
+            const int to = LastCell(local.y + size.y + delta.y, m_cellSize.y);
+            if (from <= to && IsAreaSolid(firstColumn, from, lastColumn, to)) {
+                for (int row = from; row <= to && !hit; row++) {
+                    if (IsAreaSolid(firstColumn, row, lastColumn, row)) {
+                        local.y = row * m_cellSize.y - size.y;
+                        hit = true;
+                    }
+                }
+            }
+        } else {
+            const int from = FirstCell(local.y, m_cellSize.y) - 1;
+            const int to = FirstCell(local.y + delta.y, m_cellSize.y);
+            if (to <= from && IsAreaSolid(firstColumn, to, lastColumn, from)) {
+                for (int row = from; row >= to && !hit; row--) {
+                    if (IsAreaSolid(firstColumn, row, lastColumn, row)) {
+                        local.y = (row + 1) * m_cellSize.y;
+                        hit = true;
+                    }
+                }
+            }
+        }
+        if (!hit)
+            local.y += delta.y;
+        if (hitY)
+            *hitY = hit;
+    }
+
+    return local + m_origin;
+}
+
+int CollisionGrid::FirstCell(float start, float cellSize) const {
+    return static_cast<int>(std::floor(start / cellSize + EDGE_EPSILON));
+}
+
+int CollisionGrid::LastCell(float end, float cellSize) const {
+    return static_cast<int>(std::ceil(end / cellSize - EDGE_EPSILON)) - 1;
+}
@@ -0,0 +1,84 @@
+#ifndef COLLISIONGRID_H
+#define COLLISIONGRID_H
+
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tmx {
+    class Map;
+}
+
+namespace tiled {
+    // Solid tiles of a Tiled map packed one bit per tile, 64 tiles per word.
+    // A tile is solid when its tile set tile has the bool property `collision`,
+    // when its layer has the bool property `collision`, or when its layer is one
+    // of the designated collision layers. Everything outside the map is solid.
+    class CollisionGrid {
+    public:
+        CollisionGrid();
+
+        bool Build(const tmx::Map& map, const std::vector<std::string>& collisionLayers = {});
+
+        // Where the map is drawn, e.g. the tile map entity TransformComponent
+        void SetWorldTransform(glm::vec2 position, glm::vec2 scale);
+
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        glm::vec2 GetCellSize() const { return m_cellSize; }
+        glm::vec2 GetOrigin() const { return m_origin; }
+
+        // Conversions between world positions and tiles
+        glm::ivec2 WorldToCell(glm::vec2 worldPosition) const;
+        glm::vec2 CellCenter(glm::ivec2 cell) const {
+            return m_origin + (glm::vec2(cell) + 0.5f) * m_cellSize;
+        }
+
+        // Increases on every change, cached results built from the grid compare it
+        std::uint32_t GetVersion() const { return m_version; }
+
+        void SetSolid(int column, int row, bool solid);
+
+        // O(1) tile queries
+        bool IsSolid(int column, int row) const {
+            if (column < 0 || row < 0 || column >= m_width || row >= m_height)
+                return true;
+            return (m_bits[row * m_wordsPerRow + (column >> 6)] >> (column & 63)) & 1;
+        }
+        bool IsSolidAt(glm::vec2 worldPosition) const;
+
+        // Tests 64 tiles of a row at once, the area is in tiles and inclusive
+        bool IsAreaSolid(int firstColumn, int firstRow, int lastColumn, int lastRow) const;
+
+        // Packed bits of a row, 64 tiles per word, for comparing two versions of a grid
+        const std::uint64_t* GetRowWords(int row) const { return &m_bits[row * m_wordsPerRow]; }
+        int GetWordsPerRow() const { return m_wordsPerRow; }
+
+        // Tests the tiles under a world space box
+        bool Overlaps(glm::vec2 position, glm::vec2 size) const;
+
+        // Moves a world space box by `delta`, one axis after the other, and stops it flush
+        // against the first solid tile it would enter. Returns the new box position.
+        glm::vec2 Move(glm::vec2 position, glm::vec2 size, glm::vec2 delta, bool* hitX = nullptr,
+                       bool* hitY = nullptr) const;
+
+    private:
+        std::vector<std::uint64_t> m_bits;  // [ row * m_wordsPerRow + column / 64 ]
+        int m_width;
+        int m_height;
+        int m_wordsPerRow;
+        glm::vec2 m_tileSize;  // map pixels
+        glm::vec2 m_origin;
+        glm::vec2 m_cellSize;  // world units
+        glm::vec2 m_scale;
+        std::uint32_t m_version;
+
+        // Tile range covered by a world span, `end` is exclusive
+        int FirstCell(float start, float cellSize) const;
+        int LastCell(float end, float cellSize) const;
+    };
+}  // namespace tiled
+
+#endif  // COLLISIONGRID_H
@@ -4,7 +4,11 @@
 #include <SDL.h>  // todo replace with forward declaration, see: IWYU
 #include <string>
 
+// Forward declaration
+class TextureCache;
+
 namespace tiled {
+    // Tile set image borrowed from the shared TextureCache for the time of the layer baking
     class Texture {
     public:
         Texture();
@@ -16,14 +20,16 @@ namespace tiled {
         Texture& operator=(const Texture&) = delete;
         Texture& operator=(Texture&&) = delete;
 
-        bool loadFromFile(const std::string& path, SDL_Renderer* renderer);
+        bool loadFromFile(const std::string& path, SDL_Renderer* renderer, TextureCache& cache);
         SDL_Point getSize() const;
 
         operator SDL_Texture*();
 
     private:
-        SDL_Texture* m_texture;
-        SDL_Point m_size;
+        SDL_Texture* m_texture = nullptr;
+        SDL_Point m_size = { 0, 0 };
+        TextureCache* m_cache = nullptr;
+        std::string m_path;
     };
 }  // namespace tiled
 
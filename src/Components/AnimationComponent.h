@@ -1,20 +1,24 @@
 #ifndef ANIMATIONCOMPONENT_H
 #define ANIMATIONCOMPONENT_H
 
-#include <memory>
-#include <string>
-#include <SDL.h>
-
-// Forward declaration
-struct AsepriteObject;
+#include "AssetStore/Aseprite/AsepriteObject.h"
 
 struct AnimationComponent {
-    std::shared_ptr<AsepriteObject> animationData;
-    SDL_Texture* spriteSheet;
-    int currentFrame;
-    float elapsedTime;
+    AsepriteHandle animationData;  // handle of the Aseprite object in the AssetStore
+    int tagIndex;                  // index in `AsepriteObject::frameTags`
+    int currentFrame;              // index in `AsepriteObject::frames`, -1 until resolved
+    float elapsedTime;             // milliseconds since the tag started
     bool isPlaying;
-};
 
+    // Constructor
+    AnimationComponent(AsepriteHandle _animationData = INVALID_ASEPRITE_HANDLE, int _tagIndex = 0,
+                       bool _isPlaying = true) {
+        animationData = _animationData;
+        tagIndex = _tagIndex;
+        currentFrame = -1;
+        elapsedTime = 0.0f;
+        isPlaying = _isPlaying;
+    }
+};
 
-#endif //ANIMATIONCOMPONENT_H
+#endif  // ANIMATIONCOMPONENT_H
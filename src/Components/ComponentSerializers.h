@@ -0,0 +1,68 @@
+#ifndef COMPONENTSERIALIZERS_H
+#define COMPONENTSERIALIZERS_H
+
+#include "AnimationComponent.h"
+#include "BoxColliderComponent.h"
+#include "ECS/Snapshot.h"
+#include "LifetimeComponent.h"
+#include "ParentComponent.h"
+#include "PathComponent.h"
+#include "RigidBodyComponent.h"
+#include "SpriteComponent.h"
+#include "TransformComponent.h"
+
+// Every component of `ComponentTypes` is included, the snapshot code needs them all
+
+template <>
+struct ComponentSerializer<SpriteComponent> {
+    static void Write(SnapshotWriter& writer, const SpriteComponent& sprite) {
+        writer.WriteString(sprite.assetId);
+        writer.Write(sprite.width);
+        writer.Write(sprite.height);
+        writer.Write(sprite.layer);
+        writer.Write(sprite.srcRect);
+        writer.Write(sprite.spriteType);
+        writer.Write(static_cast<std::uint32_t>(sprite.tileLayerIndexes.size()));
+        writer.Write(sprite.tileLayerIndexes.data(),
+                     sprite.tileLayerIndexes.size() * sizeof(size_t));
+    }
+
+    static void Read(SnapshotReader& reader, SpriteComponent& sprite) {
+        reader.ReadString(sprite.assetId);
+        reader.Read(sprite.width);
+        reader.Read(sprite.height);
+        reader.Read(sprite.layer);
+        reader.Read(sprite.srcRect);
+        reader.Read(sprite.spriteType);
+        std::uint32_t count = 0;
+        if (!reader.Read(count) || count > reader.GetRemaining() / sizeof(size_t)) {
+            reader.Fail();
+            return;
+        }
+        sprite.tileLayerIndexes.resize(count);
+        reader.Read(sprite.tileLayerIndexes.data(), count * sizeof(size_t));
+    }
+};
+
+// The route isn't saved, the PathfindingSystem asks for a new one
+template <>
+struct ComponentSerializer<PathComponent> {
+    static void Write(SnapshotWriter& writer, const PathComponent& path) {
+        writer.Write(path.target);
+        writer.Write(path.speed);
+        writer.Write(path.arrived);
+        writer.Write(path.goalCell);
+        writer.Write(path.previousCenter);
+    }
+
+    static void Read(SnapshotReader& reader, PathComponent& path) {
+        path = PathComponent();
+        reader.Read(path.target);
+        reader.Read(path.speed);
+        reader.Read(path.arrived);
+        reader.Read(path.goalCell);
+        reader.Read(path.previousCenter);
+    }
+};
+
+#endif  // COMPONENTSERIALIZERS_H
@@ -0,0 +1,28 @@
+#ifndef COMPONENTTYPES_H
+#define COMPONENTTYPES_H
+
+#include "ECS/TypeList.h"
+
+// Forward declaration
+struct AnimationComponent;
+struct BoxColliderComponent;
+struct LifetimeComponent;
+struct ParentComponent;
+struct PathComponent;
+struct RigidBodyComponent;
+struct SpriteComponent;
+struct TransformComponent;
+
+// Every component type, the position in the list is the component id. The ids are the same in
+// every run and every build, new components go at the end so saved data stays readable.
+using ComponentTypes = TypeList<
+    TransformComponent,
+    RigidBodyComponent,
+    SpriteComponent,
+    BoxColliderComponent,
+    AnimationComponent,
+    PathComponent,
+    ParentComponent,
+    LifetimeComponent>;
+
+#endif  // COMPONENTTYPES_H
@@ -0,0 +1,24 @@
+#ifndef LIFETIMECOMPONENT_H
+#define LIFETIMECOMPONENT_H
+
+#include <cstdint>
+
+// Kills the entity `lifetime` seconds after it was created, e.g. a bullet or an effect.
+// The LifetimeSystem keeps one timer per entity, nothing is checked every frame. The expiry
+// is saved with the entity, a loaded snapshot only waits for the rest of the lifetime.
+// A pooled entity is not killed, its EntityPool releases it, see `EntityPool`.
+struct LifetimeComponent {
+    double lifetime;
+    double expiry;  // TimerService time, negative until the timer starts
+    std::uint64_t timer;  // TimerService id, filled by the LifetimeSystem
+    bool pooled;  // set by the EntityPool
+
+    LifetimeComponent(double lifetime = 1.0) {
+        this->lifetime = lifetime;
+        this->expiry = -1.0;
+        this->timer = 0;
+        this->pooled = false;
+    }
+};
+
+#endif  // LIFETIMECOMPONENT_H
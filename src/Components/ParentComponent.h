@@ -0,0 +1,28 @@
+#ifndef PARENTCOMPONENT_H
+#define PARENTCOMPONENT_H
+
+#include "glm/glm.hpp"
+
+// Attaches the entity to a parent entity, e.g. a turret to its tank. The HierarchySystem
+// then owns the TransformComponent of the entity and places it at the local transform in
+// the parent space. Move the entity through the local values, and reparent it with
+// `HierarchySystem::SetParent`. Without a parent (-1) the entity keeps its own transform,
+// and it goes back to -1 when its parent is killed.
+struct ParentComponent {
+    int parentId;
+    glm::vec2 localPosition;
+    glm::vec2 localScale;
+    double localRotation;  // degrees, like TransformComponent::rotation
+    bool isStatic;  // the local transform never changes, only the parent moves the entity
+
+    ParentComponent(int parentId = -1, glm::vec2 localPosition = glm::vec2(0, 0),
+                    glm::vec2 localScale = glm::vec2(1, 1), double localRotation = 0.0, bool isStatic = false) {
+        this->parentId = parentId;
+        this->localPosition = localPosition;
+        this->localScale = localScale;
+        this->localRotation = localRotation;
+        this->isStatic = isStatic;
+    }
+};
+
+#endif  // PARENTCOMPONENT_H
@@ -0,0 +1,42 @@
+#ifndef PATHCOMPONENT_H
+#define PATHCOMPONENT_H
+
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Forward declaration
+struct FlowField;
+
+// Walks the entity to `target` around the solid tiles by steering its RigidBodyComponent.
+// Change `target` to send the entity somewhere else, the rest is filled by the PathfindingSystem.
+struct PathComponent {
+    glm::vec2 target;
+    float speed;
+    bool arrived;
+
+    // Route in use, a tile path or a flow field shared with the units going to the same tile
+    glm::ivec2 goalCell;
+    std::uint32_t gridVersion;
+    std::uint32_t requestId;  // 0 when no route is on the way
+    std::shared_ptr<const std::vector<glm::ivec2>> path;
+    std::size_t nextWaypoint;
+    std::shared_ptr<const FlowField> flowField;
+    glm::vec2 previousCenter;  // at the last steering, a unit moving several frames at once can pass the target
+
+    PathComponent(glm::vec2 target = glm::vec2(0), float speed = 50.0f) {
+        this->target = target;
+        this->speed = speed;
+        this->arrived = false;
+        this->goalCell = glm::ivec2(0);
+        this->gridVersion = 0;
+        this->requestId = 0;
+        this->nextWaypoint = 0;
+        this->previousCenter = glm::vec2(0);
+    }
+};
+
+#endif  // PATHCOMPONENT_H
@@ -5,11 +5,15 @@
 
 
 
+// A body at rest falls asleep and the MovementSystem stops integrating it, until the
+// component is written with a velocity again or the body is hit.
 struct RigidBodyComponent {
     glm::vec2 velocity;
+    bool sleeping;  // owned by the MovementSystem
 
     RigidBodyComponent(glm::vec2 velocity = glm::vec2(0.0, 0.0)) {
         this->velocity = velocity;
+        this->sleeping = false;
     }
 };
 
@@ -1,26 +1,70 @@
 #include "ECS.h"
 
+#include "Prefab.h"
+
 #include <spdlog/spdlog.h>
 #include <algorithm>
 
-// Initializes static methods from header
-int IComponent::nextId = 0;
-
 int Entity::GetId() const {
     return id;
 }
 
+void Entity::Kill() {
+    registry->KillEntity(*this);
+}
+
+bool Entity::IsActive() const {
+    return registry->IsActive(*this);
+}
+
 void System::AddEntityToSystem(Entity entity) {
     entities.push_back(entity);
+    membershipVersion++;
+    OnEntityAdded(entity);
+}
+
+void System::AddEntitiesToSystem(const std::vector<Entity>& newEntities) {
+    entities.insert(entities.end(), newEntities.begin(), newEntities.end());
+    membershipVersion++;
+    for (const auto& entity : newEntities)
+        OnEntityAdded(entity);
 }
 
 void System::RemoveEntityFromSystem(Entity entity) {
     // Rely on Entity::operator==
     entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
+    membershipVersion++;
+    OnEntityRemoved(entity);
+}
+
+void System::RemoveEntitiesFromSystem(const std::vector<Entity>& sortedEntities) {
+    if (sortedEntities.empty())
+        return;
+
+    // One stable pass, the draw order of the render system is kept
+    const auto removed = [&sortedEntities](const Entity& entity) {
+        return std::binary_search(sortedEntities.begin(), sortedEntities.end(), entity);
+    };
+    entities.erase(std::remove_if(entities.begin(), entities.end(), removed), entities.end());
+    membershipVersion++;
+    for (const auto& entity : sortedEntities)
+        OnEntityRemoved(entity);
+}
+
+void System::EntityKilled(Entity entity) {
+    OnEntityKilled(entity);
+}
+
+void System::EntityActivated(Entity entity) {
+    OnEntityActivated(entity);
+}
+
+void System::EntityDeactivated(Entity entity) {
+    OnEntityDeactivated(entity);
 }
 
 // Returns a reference to the entities vector, not a copy of the vector
-std::vector<Entity> System::GetSystemEntities() const {
+const std::vector<Entity>& System::GetSystemEntities() const {
     return entities;
 }
 
@@ -29,7 +73,15 @@ const Signature& System::GetComponentSignature() const {
 }
 
 Entity Registry::CreateEntity() {
-    unsigned int entityId = numEntities++;
+    unsigned int entityId;
+
+    // Reuse the id of a killed entity
+    if (freeIds.empty()) {
+        entityId = numEntities++;
+    } else {
+        entityId = freeIds.front();
+        freeIds.pop_front();
+    }
 
     // Creates new entity
     Entity entity(entityId);
@@ -41,13 +93,173 @@ Entity Registry::CreateEntity() {
     entitiesToBeAdded.insert(entity);
 
     // Make sure the entityComponentSignatures can accommodate the new entity
-    if (entityId >= entityComponentSignatures.size())
+    if (entityId >= entityComponentSignatures.size()) {
         entityComponentSignatures.resize(entityId + 1);
+        entityDormant.resize(entityId + 1);
+        entityToggled.resize(entityId + 1);
+        entityAlive.resize(entityId + 1);
+    }
+    entityAlive[entityId] = true;
+    MarkEntityChanged(entityId);
 
     spdlog::info("Entity created with id: {}", std::to_string(entityId));
     return entity;
 }
 
+void Registry::KillEntity(Entity entity) {
+    entitiesToBeKilled.insert(entity);
+}
+
+std::vector<Entity> Registry::Instantiate(const Prefab& prefab, std::size_t count, bool active) {
+    std::vector<Entity> entities;
+    entities.reserve(count);
+
+    // Reuse the ids of the killed entities, then take a block of new ones
+    while (entities.size() < count && !freeIds.empty()) {
+        entities.emplace_back(freeIds.front());
+        freeIds.pop_front();
+    }
+    const unsigned int firstNewId = numEntities;
+    numEntities += static_cast<unsigned int>(count - entities.size());
+    for (unsigned int entityId = firstNewId; entityId < numEntities; entityId++)
+        entities.emplace_back(entityId);
+
+    for (auto& entity : entities)
+        entity.registry = this;
+    if (numEntities > entityComponentSignatures.size()) {
+        entityComponentSignatures.resize(numEntities);
+        entityDormant.resize(numEntities);
+        entityToggled.resize(numEntities);
+        entityAlive.resize(numEntities);
+    }
+    for (const auto& entity : entities) {
+        entityAlive[entity.GetId()] = true;
+        MarkEntityChanged(entity.GetId());
+    }
+
+    prefab.AddTo(*this, entities);
+    if (!active) {
+        for (const auto& entity : entities)
+            entityDormant[entity.GetId()] = true;
+    }
+    batchToBeAdded.insert(batchToBeAdded.end(), entities.begin(), entities.end());
+
+    spdlog::info("Instantiated {} entities", count);
+    return entities;
+}
+
+void Registry::DeactivateEntity(Entity entity) {
+    SetDormant(entity, true);
+}
+
+void Registry::ActivateEntity(Entity entity) {
+    SetDormant(entity, false);
+}
+
+void Registry::SetDormant(Entity entity, bool dormant) {
+    const auto entityId = entity.GetId();
+    if (entityDormant[entityId] == dormant)
+        return;
+
+    if (!entityToggled[entityId]) {
+        entityToggled[entityId] = true;
+        entitiesToBeToggled.emplace_back(entity, entityDormant[entityId]);
+    }
+    entityDormant[entityId] = dormant;
+    MarkEntityChanged(entityId);
+}
+
+void Registry::MarkEntityChanged(int entityId) {
+    if (entityChangeLog.GetReaderCount() == 0)
+        return;
+
+    const auto index = static_cast<std::size_t>(entityId);
+    if (index >= entityChangeTicks.size())
+        entityChangeTicks.resize(std::max<std::size_t>(index + 1, numEntities), 0);
+    if (entityChangeTicks[index] != changeTick)
+        entityChangeLog.Add(changeTick, entityId);
+    entityChangeTicks[index] = changeTick;
+}
+
+void Registry::NotifyToggledEntities() {
+    for (const auto& toggled : entitiesToBeToggled) {
+        const Entity entity = toggled.first;
+        const auto entityId = entity.GetId();
+        if (!entityToggled[entityId])
+            continue;
+        entityToggled[entityId] = false;
+
+        // Back to dormant, the systems never saw it active. Back to active, it was released
+        // and acquired again, the systems see it leave and come back.
+        const bool dormant = entityDormant[entityId];
+        const bool wasDormant = toggled.second;
+        if (dormant && wasDormant)
+            continue;
+
+        const auto& entityComponentSignature = entityComponentSignatures[entityId];
+        for (auto& system : systems) {
+            if (!entityComponentSignature.Contains(system.second->GetComponentSignature()))
+                continue;
+            if (!dormant && !wasDormant)
+                system.second->EntityDeactivated(entity);
+            if (dormant)
+                system.second->EntityDeactivated(entity);
+            else
+                system.second->EntityActivated(entity);
+        }
+    }
+    entitiesToBeToggled.clear();
+}
+
+bool Registry::IsActive(Entity entity) const {
+    return !entityDormant[entity.GetId()];
+}
+
+bool Registry::IsAlive(Entity entity) const {
+    const auto entityId = static_cast<std::size_t>(entity.GetId());
+    return entityId < entityAlive.size() && entityAlive[entityId];
+}
+
+void Registry::RemoveEntityFromSystems(Entity entity) {
+    const auto& entityComponentSignature = entityComponentSignatures[entity.GetId()];
+
+    for (auto& system : systems) {
+        const auto& systemComponentSignature = system.second->GetComponentSignature();
+        if (entityComponentSignature.Contains(systemComponentSignature))
+            system.second->RemoveEntityFromSystem(entity);
+    }
+}
+
+void Registry::RemoveEntitiesFromSystems(const std::vector<Entity>& sortedEntities) {
+    for (auto& system : systems) {
+        const auto& systemComponentSignature = system.second->GetComponentSignature();
+
+        systemBatch.clear();
+        for (const auto& entity : sortedEntities) {
+            const auto& entityComponentSignature = entityComponentSignatures[entity.GetId()];
+            if (entityComponentSignature.Contains(systemComponentSignature))
+                systemBatch.push_back(entity);
+        }
+        if (!systemBatch.empty())
+            system.second->RemoveEntitiesFromSystem(systemBatch);
+    }
+}
+
+void Registry::AddEntitiesToSystems(const std::vector<Entity>& entities) {
+    for (auto& system : systems) {
+        const auto& systemComponentSignature = system.second->GetComponentSignature();
+
+        systemBatch.clear();
+        for (const auto& entity : entities) {
+            const auto& entityComponentSignature = entityComponentSignatures[entity.GetId()];
+            if (entityComponentSignature.Contains(systemComponentSignature))
+                systemBatch.push_back(entity);
+        }
+        if (!systemBatch.empty())
+            system.second->AddEntitiesToSystem(systemBatch);
+    }
+}
+
 void Registry::AddEntityToSystems(Entity entity) {
     // Get entity id
     const auto entityId = entity.GetId();
@@ -60,8 +272,7 @@ void Registry::AddEntityToSystems(Entity entity) {
         const auto& systemComponentSignature = system.second->GetComponentSignature();
 
         // Bitwise comparison between the entity and system signatures
-        bool isInterested = (entityComponentSignature & systemComponentSignature)
-                            == systemComponentSignature;
+        bool isInterested = entityComponentSignature.Contains(systemComponentSignature);
 
         // Add entity to the system
         if (isInterested)
@@ -69,15 +280,49 @@ void Registry::AddEntityToSystems(Entity entity) {
     }
 }
 
+std::uint32_t Registry::TakeChangeTick() {
+    return changeTick++;
+}
+
 void Registry::Update() {
-    // Add entities from the creating waiting list to the active systems
-    for (auto entity : entitiesToBeAdded)
+    // Add entities from the creating waiting list to the active systems. They join with their
+    // current activation, toggling them before changed nothing for the systems.
+    for (auto entity : entitiesToBeAdded) {
         AddEntityToSystems(entity);
+        entityToggled[entity.GetId()] = false;
+    }
     entitiesToBeAdded.clear();
+    AddEntitiesToSystems(batchToBeAdded);
+    for (const auto& entity : batchToBeAdded)
+        entityToggled[entity.GetId()] = false;
+    batchToBeAdded.clear();
 
-    // TODO: Remove entities from the deleting waiting list from the active systems
-    // for (auto entity: entitiesToBeKilled) {
-    //     KillEntity(entity);
-    // }
-    // entitiesToBeKilled.clear();
+    // The killed entities only leave, whatever their activation
+    for (const auto& entity : entitiesToBeKilled)
+        entityToggled[entity.GetId()] = false;
+    NotifyToggledEntities();
+
+    // Remove entities from the deleting waiting list from the active systems. A handle killed
+    // after its entity already died is skipped, the id is free or reused. The set is sorted by
+    // id, the systems drop the whole batch in one pass.
+    killBatch.clear();
+    for (auto entity : entitiesToBeKilled) {
+        if (!entityAlive[entity.GetId()])
+            continue;
+        entityAlive[entity.GetId()] = false;
+        killBatch.push_back(entity);
+    }
+    entitiesToBeKilled.clear();
+    RemoveEntitiesFromSystems(killBatch);
+
+    for (auto entity : killBatch) {
+        for (auto& system : systems)
+            system.second->EntityKilled(entity);
+        entityComponentSignatures[entity.GetId()].reset();
+        entityDormant[entity.GetId()] = false;
+        MarkEntityChanged(entity.GetId());
+
+        // Make the entity id available to be reused
+        freeIds.push_back(entity.GetId());
+    }
 }
\ No newline at end of file
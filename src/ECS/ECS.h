@@ -1,8 +1,13 @@
 #ifndef ECS_H
 #define ECS_H
 
+#include "Components/ComponentTypes.h"
+#include "Signature.h"
+
 #include <spdlog/spdlog.h>
-#include <bitset>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <set>
 #include <string>
@@ -11,30 +16,28 @@
 #include <utility>
 #include <vector>
 
-const unsigned int MAX_COMPONENTS = 32;
+// A multiple of 128
+const unsigned int MAX_COMPONENTS = 128;
 
 //------------------------------------------------------------------------
 // Signature
 //------------------------------------------------------------------------
-// typedef std::bitset<MAX_COMPONENTS> Signature; // C style
-using Signature = std::bitset<MAX_COMPONENTS>;  // Modern C++
+using Signature = BasicSignature<MAX_COMPONENTS>;
 
-// Class template. A parent class for components
-struct IComponent {
-protected:
-    static int nextId;
-};
+static_assert(ComponentTypes::size <= MAX_COMPONENTS, "Too many components for the signature");
 
 //------------------------------------------------------------------------
 // Components
 //------------------------------------------------------------------------
 // Class template that is used to assign a unique id to a component type
 template <typename TComponent>
-class Component : public IComponent {
+class Component {
+    static constexpr int id = IndexOf<TComponent>(ComponentTypes());
+    static_assert(id >= 0, "The component type is missing from ComponentTypes");
+
 public:
-    // Returns the unique id of Component<T>
-    static int GetId() {  // will exist for each component type separately
-        static auto id = nextId++;
+    // Returns the unique id of Component<T>, its position in `ComponentTypes`
+    static constexpr int GetId() {
         return id;
     }
 };
@@ -50,6 +53,8 @@ public:
         : id(id){};  // Constructor, initialize automatically
     Entity(const Entity& entity) = default;
     int GetId() const;
+    void Kill();
+    bool IsActive() const;
 
     // Operator overloading
     Entity& operator=(const Entity& other) = default;
@@ -83,6 +88,15 @@ public:
     template <typename TComponent>
     TComponent& GetComponent() const;
 
+    template <typename TComponent>
+    const TComponent& ReadComponent() const;
+
+    template <typename TComponent, typename TFunction>
+    void Patch(TFunction&& function) const;
+
+    template <typename TComponent>
+    bool HasChanged(std::uint32_t since) const;
+
     // Hold a pointer to the entity's owner registry
     class Registry* registry;  // forward declaration of `Registry` class
 };
@@ -93,19 +107,104 @@ public:
 class System {
     Signature componentSignature;
     std::vector<Entity> entities;
+    std::uint32_t membershipVersion = 0;  // changes with `entities`
 
 public:
     System() = default;
-    ~System() = default;
+    virtual ~System() = default;
 
     void AddEntityToSystem(Entity entity);
+    void AddEntitiesToSystem(const std::vector<Entity>& newEntities);
     void RemoveEntityFromSystem(Entity entity);
-    std::vector<Entity> GetSystemEntities() const;
+    // `sortedEntities` sorted by id, the remaining entities keep their order
+    void RemoveEntitiesFromSystem(const std::vector<Entity>& sortedEntities);
+    const std::vector<Entity>& GetSystemEntities() const;
     const Signature& GetComponentSignature() const;
 
+    // Changes whenever entities join or leave the system
+    std::uint32_t GetMembershipVersion() const { return membershipVersion; }
+
+    // Tells the system an entity is killed, whether the system holds it or not
+    void EntityKilled(Entity entity);
+
+    // Tells the system one of its entities was activated/deactivated, see `Registry::ActivateEntity`
+    void EntityActivated(Entity entity);
+    void EntityDeactivated(Entity entity);
+
     // Defines the component type that entities must have to be considered by the system
     template <typename TComponent>
     void RequireComponent();
+
+protected:
+    // Called when an entity joins/leaves the system, e.g. to keep its assets alive
+    virtual void OnEntityAdded(Entity entity) {}
+    virtual void OnEntityRemoved(Entity entity) {}
+
+    // Called for every killed entity, before its id can be reused, e.g. to drop references to it.
+    // The components of the entity can still be read.
+    virtual void OnEntityKilled(Entity entity) {}
+
+    // A dormant entity stays in the system and should be skipped by it. Entities may join the
+    // system dormant, `OnEntityAdded` can tell with `Entity::IsActive()`.
+    virtual void OnEntityActivated(Entity entity) {}
+    virtual void OnEntityDeactivated(Entity entity) {}
+};
+
+//------------------------------------------------------------------------
+// Change log
+//------------------------------------------------------------------------
+// (tick, id) of the slots stamped with a new change tick, oldest first. Every reader gets the
+// entries logged since its previous read, the entries all the readers went past are dropped,
+// so a reader that stops reading keeps the log growing. Nothing is logged without a reader.
+class ChangeLog {
+    std::vector<std::pair<std::uint32_t, int>> entries;
+    std::size_t start = 0;  // position of `entries[0]` since the log started
+    std::vector<std::size_t> readers;  // [ reader ] position of its next entry
+
+public:
+    int AddReader() {
+        readers.push_back(start + entries.size());
+        return static_cast<int>(readers.size()) - 1;
+    }
+
+    std::size_t GetReaderCount() const {
+        return readers.size();
+    }
+
+    bool IsEmpty() const {
+        return entries.empty();
+    }
+
+    // Drops the entries, `count` readers start over
+    void Reset(std::size_t count) {
+        entries.clear();
+        start = 0;
+        readers.assign(count, 0);
+    }
+
+    void Add(std::uint32_t tick, int id) {
+        if (!readers.empty())
+            entries.emplace_back(tick, id);
+    }
+
+    // Calls `function(tick, id)` for every entry the reader hasn't seen. The function may add
+    // entries, they are left for the next read.
+    template <typename TFunction>
+    void Read(int reader, TFunction&& function) {
+        const std::size_t end = start + entries.size();
+        for (std::size_t position = readers[reader]; position < end; position++) {
+            const auto entry = entries[position - start];
+            function(entry.first, entry.second);
+        }
+        readers[reader] = end;
+
+        // Erased in bulk, once the read part is the larger one
+        const std::size_t read = *std::min_element(readers.begin(), readers.end()) - start;
+        if (read > 0 && read * 2 >= entries.size()) {
+            entries.erase(entries.begin(), entries.begin() + read);
+            start += read;
+        }
+    }
 };
 
 //------------------------------------------------------------------------
@@ -114,16 +213,21 @@ public:
 class IPool {
 public:
     virtual ~IPool(){};
+    virtual ChangeLog& GetChangeLog() = 0;
+    virtual void MarkAllChanged(std::uint32_t tick) = 0;
 };
 
 // Collection of objects of type T
 template <typename T>
 class Pool : public IPool {
     std::vector<T> data;
+    std::vector<std::uint32_t> changeTicks;  // [ index = entity id ] see `Registry::TakeChangeTick`
+    ChangeLog changeLog;  // see `Registry::TrackChanges`
 
 public:
     Pool(int size = 50) {
         data.resize(size);
+        changeTicks.resize(size);
     }
 
     virtual ~Pool() = default;  // compiler will generate the default implementation of the destructor
@@ -138,24 +242,73 @@ public:
 
     void Resize(int n) {
         data.resize(n);
+        changeTicks.resize(n);
     }
 
     void Clear() {
         data.clear();
+        changeTicks.clear();
+        changeLog.Reset(changeLog.GetReaderCount());
     }
 
     void Add(T object) {
         data.push_back(object);
+        changeTicks.push_back(0);
     }
 
     void Set(int index, T object) {
         data[index] = object;
     }
 
+    // [ index = entity id ] for bulk copies
+    T* GetData() {
+        return data.data();
+    }
+
+    const T* GetData() const {
+        return data.data();
+    }
+
     T& Get(int index) {
         return static_cast<T&>(data[index]);
     }
 
+    const T& Get(int index) const {
+        return data[index];
+    }
+
+    std::uint32_t GetChangeTick(int index) const {
+        return changeTicks[index];
+    }
+
+    void MarkChanged(int index, std::uint32_t tick) {
+        if (changeTicks[index] != tick)
+            changeLog.Add(tick, index);
+        changeTicks[index] = tick;
+    }
+
+    void MarkAllChanged(std::uint32_t tick) override {
+        std::fill(changeTicks.begin(), changeTicks.end(), tick);
+        if (changeLog.GetReaderCount() > 0) {
+            for (int index = 0; index < GetSize(); index++)
+                changeLog.Add(tick, index);
+        }
+    }
+
+    ChangeLog& GetChangeLog() override {
+        return changeLog;
+    }
+
+    // Calls `function(index)` once per slot stamped since the reader's previous read
+    template <typename TFunction>
+    void ForEachChanged(int reader, TFunction&& function) {
+        changeLog.Read(reader, [this, &function](std::uint32_t tick, int index) {
+            // A slot stamped again is only reported with its latest tick
+            if (index < GetSize() && changeTicks[index] == tick)
+                function(index);
+        });
+    }
+
     // Operator overloading
     T& operator[](unsigned int index) {
         return data[index];
@@ -165,6 +318,14 @@ public:
 //------------------------------------------------------------------------
 // Registry
 //------------------------------------------------------------------------
+// Forward declaration
+class Prefab;
+class RollbackBuffer;
+class SnapshotReader;
+class SnapshotWriter;
+template <typename... TTerms>
+class View;
+
 // Manages the creation/destruction of entities and adding/removing components and systems
 class Registry {
     // Keep track of how many entities were added to the scene
@@ -187,6 +348,42 @@ class Registry {
     std::set<Entity> entitiesToBeAdded;
     std::set<Entity> entitiesToBeKilled;
 
+    // Entities of `Instantiate()` calls, added to the systems in one pass
+    std::vector<Entity> batchToBeAdded;
+
+    // Ids of the killed entities, reused by `CreateEntity()`
+    std::deque<int> freeIds;
+
+    // [ index = entity id ] false from the kill until the id is reused, a stale handle killed
+    // again doesn't free the id twice
+    std::vector<bool> entityAlive;
+
+    // [ index = entity id ] dormant entities stay in their systems, which skip them
+    std::vector<bool> entityDormant;
+
+    // Entities whose activation changed, with the dormant flag the systems last saw. The
+    // systems are told in the next `Update()`.
+    std::vector<std::pair<Entity, bool>> entitiesToBeToggled;
+    std::vector<bool> entityToggled;  // [ index = entity id ] in `entitiesToBeToggled`
+
+    // Reused by the batch operations of `Update()`
+    std::vector<Entity> systemBatch;
+    std::vector<Entity> killBatch;
+
+    // Stamped on the component slots obtained mutably, see `TakeChangeTick()`
+    std::uint32_t changeTick = 1;
+
+    // [ component id ] readers of the change log of the pool, see `TrackChanges()`
+    std::vector<std::size_t> changeReaders;
+
+    // Entities whose signature or activation changed, and the tick they were last logged at
+    ChangeLog entityChangeLog;
+    std::vector<std::uint32_t> entityChangeTicks;  // [ index = entity id ]
+
+    template <typename... TTerms>
+    friend class View;
+    friend class RollbackBuffer;
+
 public:
     Registry() {
         spdlog::info("Registry constructor called.");
@@ -201,25 +398,95 @@ public:
     // Entity management
     Entity CreateEntity();
 
+    // Destroys the entity in the next `Update()`
+    void KillEntity(Entity entity);
+
+    // Creates `count` entities with the components of the prefab. The ids, the pool slots and
+    // the signatures are set up once for the whole batch, and the batch joins the systems in
+    // the next `Update()`.
+    // Inactive entities are created dormant, they join the systems but are skipped by them.
+    std::vector<Entity> Instantiate(const Prefab& prefab, std::size_t count = 1,
+                                    bool active = true);
+
+    // A dormant entity keeps its id, its components, its signature and its place in the
+    // systems, only its flag changes, so pooling entities edits no system list. The systems
+    // and the views skip it from now on, and the systems are told about the change in the next
+    // `Update()`, e.g. to restart a timer with the state set after the activation. An entity
+    // deactivated and activated again before that is told both, like a new one. See `EntityPool`.
+    void DeactivateEntity(Entity entity);
+    void ActivateEntity(Entity entity);
+    bool IsActive(Entity entity) const;
+
+    // False once the entity is killed, until its id is reused
+    bool IsAlive(Entity entity) const;
+
+    // Saves the whole state, entities, components and system membership, in a compact binary
+    // snapshot, e.g. for a quick-save or a level restart. Taken between two `Update()` calls,
+    // the entities waiting for the next update are left out.
+    void SaveSnapshot(std::vector<std::uint8_t>& snapshot) const;
+
+    // Replaces the whole state with a snapshot of the same build, the pools are rebuilt
+    // directly. The systems see their entities leave and the saved ones join, in the saved
+    // order, the dormant ones included. False when the snapshot can't be read, the registry
+    // is unchanged then.
+    bool LoadSnapshot(const std::vector<std::uint8_t>& snapshot);
+
     // Checks the component signature of an entity
     // and add the entity to the systems that are interested in it
     void AddEntityToSystems(Entity entity);
-
-    // void KillEntity(Entity entity);
+    void AddEntitiesToSystems(const std::vector<Entity>& entities);
+    void RemoveEntityFromSystems(Entity entity);
+    // `sortedEntities` sorted by id, one pass over the entities of each system
+    void RemoveEntitiesFromSystems(const std::vector<Entity>& sortedEntities);
 
     // Template functions for components management
     template <typename TComponent, typename... TArgs>
     void AddComponent(Entity entity, TArgs&&... args);
 
+    // Copies `component` to every entity, without logging each one
+    template <typename TComponent>
+    void AddComponents(const std::vector<Entity>& entities, const TComponent& component);
+
     template <typename TComponent>
     void RemoveComponent(Entity entity);
 
     template <typename TComponent>
     bool HasComponent(Entity entity) const;
 
+    // Counts as a change of the component, see `TakeChangeTick()`
     template <typename TComponent>
     TComponent& GetComponent(Entity entity) const;
 
+    // Read only access, not a change
+    template <typename TComponent>
+    const TComponent& ReadComponent(Entity entity) const;
+
+    // Calls `function(component&)` and marks the component changed
+    template <typename TComponent, typename TFunction>
+    void Patch(Entity entity, TFunction&& function);
+
+    // Every component slot keeps the tick of its last mutable access: added, got through
+    // `GetComponent()` or patched. A consumer keeps the tick this returns and next time asks
+    // for the changes since then, with `HasChanged()` or a `View` with `Changed<T>` terms.
+    // The writes after the call get a later tick. Loading a snapshot changes everything.
+    std::uint32_t TakeChangeTick();
+
+    // Mutably accessed after `since`. Ticks wrap around, `since` should be less than 2^31
+    // ticks old.
+    template <typename TComponent>
+    bool HasChanged(Entity entity, std::uint32_t since) const;
+
+    // Adds a reader to the log of the entities whose TComponent gets a new change tick, read
+    // with `ForEachChanged()`. Loading a snapshot logs every entity.
+    template <typename TComponent>
+    int TrackChanges();
+
+    // Calls `function(entity)` once per entity whose TComponent changed since the previous
+    // read of `reader`. The cost follows the changes and not the pool size. Takes a change
+    // tick, the writes from now on are in the next read.
+    template <typename TComponent, typename TFunction>
+    void ForEachChanged(int reader, TFunction&& function);
+
     // Template functions for systems management
     template <typename TSystem, typename... TArgs>
     void AddSystem(TArgs&&... args);
@@ -232,6 +499,34 @@ public:
 
     template <typename TSystem>
     TSystem& GetSystem() const;
+
+private:
+    void SetDormant(Entity entity, bool dormant);
+
+    // Logs a change of the signature or the activation of the entity
+    void MarkEntityChanged(int entityId);
+
+    // Puts a whole state in place, the pools are taken as they are. The systems see their
+    // entities leave and the ones of `membership` join, in that order, a system missing from
+    // it takes its entities by signature. Every entity and component counts as changed.
+    void ReplaceState(unsigned int entityCount, std::vector<Signature> signatures,
+                      std::vector<std::shared_ptr<IPool>> pools, const std::vector<std::uint8_t>& dormant,
+                      const std::vector<int>& free,
+                      const std::unordered_map<std::string, std::vector<Entity>>& membership);
+
+    // Tells the systems of the toggled entities about their activation
+    void NotifyToggledEntities();
+
+    // Creates the pool of the component type on first use
+    template <typename TComponent>
+    Pool<TComponent>& GetPool();
+
+    // One component type of a snapshot, defined with `SaveSnapshot`
+    template <typename TComponent>
+    void SaveComponents(SnapshotWriter& writer) const;
+    template <typename TComponent>
+    bool LoadComponents(SnapshotReader& reader, const std::vector<Signature>& signatures,
+                        std::vector<std::shared_ptr<IPool>>& pools) const;
 };
 
 //------------------------------------------------------------------------
@@ -279,11 +574,9 @@ TSystem& Registry::GetSystem() const {
     return *(std::static_pointer_cast<TSystem>(system->second));
 }
 
-template <typename TComponent, typename... TArgs>
-void Registry::AddComponent(Entity entity, TArgs&&... args) {
-    // Get a component/entity id
+template <typename TComponent>
+Pool<TComponent>& Registry::GetPool() {
     const auto componentId = Component<TComponent>::GetId();
-    const auto entityId = entity.GetId();
 
     // Resize the pools of components
     if (componentId >= componentPools.size())
@@ -292,12 +585,22 @@ void Registry::AddComponent(Entity entity, TArgs&&... args) {
     // If nothing within the current position
     if (!componentPools[componentId]) {
         std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>();
+        if (componentId < changeReaders.size())
+            newComponentPool->GetChangeLog().Reset(changeReaders[componentId]);
         componentPools[componentId] = newComponentPool;  // assigns the current position
     }
 
+    return *static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent, typename... TArgs>
+void Registry::AddComponent(Entity entity, TArgs&&... args) {
+    // Get a component/entity id
+    const auto componentId = Component<TComponent>::GetId();
+    const auto entityId = entity.GetId();
+
     // Get the component pool
-    std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(
-        componentPools[componentId]);
+    Pool<TComponent>* componentPool = &GetPool<TComponent>();
 
     // Resize current component pool
     if (entityId >= componentPool->GetSize())
@@ -308,14 +611,33 @@ void Registry::AddComponent(Entity entity, TArgs&&... args) {
 
     // Set the position
     componentPool->Set(entityId, newComponent);
+    componentPool->MarkChanged(entityId, changeTick);
 
     // Enable the bitset signature
     entityComponentSignatures[entityId].set(componentId);
+    MarkEntityChanged(entityId);
 
     spdlog::info("Component id = " + std::to_string(componentId) + " was added to entity id "
                 + std::to_string(entityId));
 }
 
+template <typename TComponent>
+void Registry::AddComponents(const std::vector<Entity>& entities, const TComponent& component) {
+    const auto componentId = Component<TComponent>::GetId();
+    auto& componentPool = GetPool<TComponent>();
+
+    // One resize covers the whole batch
+    if (componentPool.GetSize() < static_cast<int>(numEntities))
+        componentPool.Resize(numEntities);
+
+    for (const auto& entity : entities) {
+        componentPool[entity.GetId()] = component;
+        componentPool.MarkChanged(entity.GetId(), changeTick);
+        entityComponentSignatures[entity.GetId()].set(componentId);
+        MarkEntityChanged(entity.GetId());
+    }
+}
+
 template <typename TComponent>
 void Registry::RemoveComponent(Entity entity) {
     // Get a component/entity id
@@ -324,6 +646,7 @@ void Registry::RemoveComponent(Entity entity) {
 
     // Disable the bitset signature
     entityComponentSignatures[entityId].set(componentId, false);
+    MarkEntityChanged(entityId);
 
     spdlog::info("Component id = " + std::to_string(componentId) + " was removed from entity id "
                 + std::to_string(entityId));
@@ -348,16 +671,64 @@ TComponent& Registry::GetComponent(Entity entity) const {
     const auto componentId = Component<TComponent>::GetId();
     const auto entityId = entity.GetId();
 
-    // Fetch the component object
-    auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+    // Fetch the component object, a raw pointer avoids touching the shared_ptr ref count
+    auto* componentPool = static_cast<Pool<TComponent>*>(componentPools[componentId].get());
 
     // Logger::Log("Get a component id = " + std::to_string(componentId) + " from Entity id " +
     // std::to_string(entityId));
 
     // Return the component by index
+    componentPool->MarkChanged(entityId, changeTick);
     return componentPool->Get(entityId);
 }
 
+template <typename TComponent>
+const TComponent& Registry::ReadComponent(Entity entity) const {
+    const auto componentId = Component<TComponent>::GetId();
+    const auto* componentPool =
+        static_cast<const Pool<TComponent>*>(componentPools[componentId].get());
+    return componentPool->Get(entity.GetId());
+}
+
+template <typename TComponent, typename TFunction>
+void Registry::Patch(Entity entity, TFunction&& function) {
+    function(GetComponent<TComponent>(entity));
+}
+
+template <typename TComponent>
+bool Registry::HasChanged(Entity entity, std::uint32_t since) const {
+    const auto componentId = Component<TComponent>::GetId();
+    const auto entityId = entity.GetId();
+    if (componentId >= static_cast<int>(componentPools.size()) || !componentPools[componentId])
+        return false;
+
+    const auto* componentPool =
+        static_cast<const Pool<TComponent>*>(componentPools[componentId].get());
+    if (entityId >= componentPool->GetSize())
+        return false;
+    return static_cast<std::int32_t>(componentPool->GetChangeTick(entityId) - since) > 0;
+}
+
+template <typename TComponent>
+int Registry::TrackChanges() {
+    const auto componentId = static_cast<std::size_t>(Component<TComponent>::GetId());
+    auto& changeLog = GetPool<TComponent>().GetChangeLog();
+    if (componentId >= changeReaders.size())
+        changeReaders.resize(componentId + 1, 0);
+    changeReaders[componentId]++;
+    return changeLog.AddReader();
+}
+
+template <typename TComponent, typename TFunction>
+void Registry::ForEachChanged(int reader, TFunction&& function) {
+    TakeChangeTick();
+    GetPool<TComponent>().ForEachChanged(reader, [this, &function](int entityId) {
+        Entity entity(entityId);
+        entity.registry = this;
+        function(entity);
+    });
+}
+
 // Entity's template functions
 
 template <typename TComponent, typename... TArgs>
@@ -381,4 +752,19 @@ TComponent& Entity::GetComponent() const {
     return registry->GetComponent<TComponent>(*this);
 }
 
+template <typename TComponent>
+const TComponent& Entity::ReadComponent() const {
+    return registry->ReadComponent<TComponent>(*this);
+}
+
+template <typename TComponent, typename TFunction>
+void Entity::Patch(TFunction&& function) const {
+    registry->Patch<TComponent>(*this, std::forward<TFunction>(function));
+}
+
+template <typename TComponent>
+bool Entity::HasChanged(std::uint32_t since) const {
+    return registry->HasChanged<TComponent>(*this, since);
+}
+
 #endif  // ECS_H
@@ -0,0 +1,82 @@
+#include "EntityPool.h"
+
+#include "Components/LifetimeComponent.h"
+#include "Events/LifetimeExpiredEvent.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    // First batch of a pool created empty
+    constexpr std::size_t MIN_GROWTH = 16;
+}  // namespace
+
+EntityPool::EntityPool(Registry& registry, Prefab prefab, std::size_t initialSize, EventBus* eventBus)
+    : registry(&registry), prefab(std::move(prefab)), eventBus(eventBus) {
+    if (eventBus) {
+        expiredSubscription =
+            eventBus->Subscribe<LifetimeExpiredEvent>([this](EventBatch<LifetimeExpiredEvent> events) {
+                for (const auto& event : events) {
+                    if (event.entity.ReadComponent<LifetimeComponent>().pooled)
+                        Release(event.entity);
+                }
+            });
+    }
+    Reserve(initialSize);
+}
+
+EntityPool::~EntityPool() {
+    if (eventBus)
+        eventBus->Unsubscribe(expiredSubscription);
+}
+
+Entity EntityPool::Acquire() {
+    // Killed while dormant, the id isn't the pool's anymore
+    while (!dormant.empty() && !registry->IsAlive(dormant.back())) {
+        members[dormant.back().GetId()] = false;
+        dormant.pop_back();
+    }
+    if (dormant.empty())
+        Reserve(std::max(entities.size(), MIN_GROWTH));
+
+    const Entity entity = dormant.back();
+    dormant.pop_back();
+    registry->ActivateEntity(entity);
+    return entity;
+}
+
+void EntityPool::Release(Entity entity) {
+    const auto entityId = static_cast<std::size_t>(entity.GetId());
+    if (entityId >= members.size() || !members[entityId] || !registry->IsAlive(entity) ||
+        !registry->IsActive(entity))
+        return;
+
+    registry->DeactivateEntity(entity);
+    dormant.push_back(entity);
+}
+
+void EntityPool::Reserve(std::size_t count) {
+    if (count <= dormant.size())
+        return;
+
+    const auto newEntities = registry->Instantiate(prefab, count - dormant.size(), false);
+    for (const auto& entity : newEntities) {
+        if (static_cast<std::size_t>(entity.GetId()) >= members.size())
+            members.resize(entity.GetId() + 1);
+        members[entity.GetId()] = true;
+
+        // Expires back into the pool
+        if (eventBus && entity.HasComponent<LifetimeComponent>())
+            entity.GetComponent<LifetimeComponent>().pooled = true;
+    }
+    entities.insert(entities.end(), newEntities.begin(), newEntities.end());
+    dormant.insert(dormant.end(), newEntities.begin(), newEntities.end());
+}
+
+void EntityPool::Reclaim() {
+    dormant.clear();
+    for (const auto& entity : entities) {
+        if (registry->IsAlive(entity) && !registry->IsActive(entity))
+            dormant.push_back(entity);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef ENTITYPOOL_H
+#define ENTITYPOOL_H
+
+#include "ECS.h"
+#include "EventBus/EventBus.h"
+#include "Prefab.h"
+
+#include <cstddef>
+#include <vector>
+
+// Recycles the entities of one prefab, e.g. bullets or particles. A released entity is
+// deactivated instead of killed: it keeps its components and its place in the systems, which
+// skip it, and acquiring it again only flips it back. Once the pool is warm, spawning and
+// despawning allocate nothing and edit no system list. Acquired entities keep the component
+// values they had when released, the caller sets their state. Pooled entities are released,
+// not killed.
+// With an event bus, the entities whose LifetimeComponent expires are released instead of
+// killed by the LifetimeSystem.
+class EntityPool {
+    Registry* registry;
+    Prefab prefab;
+    std::vector<Entity> entities;
+    std::vector<Entity> dormant;
+    std::vector<bool> members;  // [ entity id ]
+
+    EventBus* eventBus = nullptr;
+    EventBus::SubscriptionId expiredSubscription = 0;
+
+public:
+    EntityPool(Registry& registry, Prefab prefab, std::size_t initialSize = 0,
+               EventBus* eventBus = nullptr);
+    ~EntityPool();
+
+    // The expired lifetimes are delivered to this pool
+    EntityPool(const EntityPool&) = delete;
+    EntityPool& operator=(const EntityPool&) = delete;
+
+    // Seen by the systems at once, told to them in the next `Registry::Update()`. An empty
+    // pool grows by its size, the new entities join the systems in the next update.
+    Entity Acquire();
+
+    // Ignored for an entity already released, killed or not from this pool
+    void Release(Entity entity);
+
+    // Instantiates dormant entities until the pool holds `count` of them
+    void Reserve(std::size_t count);
+
+    // Takes the dormant entities from the registry again, e.g. after loading a snapshot
+    void Reclaim();
+
+    std::size_t GetSize() const { return entities.size(); }
+    std::size_t GetDormantCount() const { return dormant.size(); }
+};
+
+#endif  // ENTITYPOOL_H
@@ -0,0 +1,61 @@
+#ifndef PREFAB_H
+#define PREFAB_H
+
+#include "ECS.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A set of components with their default values, e.g. a bullet. `Registry::Instantiate`
+// copies them to a whole batch of new entities at once. Copies of a prefab share the
+// component values.
+class Prefab {
+    struct IComponentDefaults {
+        virtual ~IComponentDefaults() = default;
+        virtual void AddTo(Registry& registry, const std::vector<Entity>& entities) const = 0;
+    };
+
+    template <typename TComponent>
+    struct ComponentDefaults : IComponentDefaults {
+        TComponent component;
+
+        explicit ComponentDefaults(TComponent component) : component(std::move(component)) {}
+
+        void AddTo(Registry& registry, const std::vector<Entity>& entities) const override {
+            registry.AddComponents(entities, component);
+        }
+    };
+
+    // [ index = component id ] nullptr for the components the prefab doesn't have
+    std::vector<std::shared_ptr<const IComponentDefaults>> components;
+
+public:
+    // Replaces the component of the same type
+    template <typename TComponent, typename... TArgs>
+    Prefab& AddComponent(TArgs&&... args) {
+        const auto componentId = static_cast<std::size_t>(Component<TComponent>::GetId());
+        if (componentId >= components.size())
+            components.resize(componentId + 1);
+
+        components[componentId] =
+            std::make_shared<ComponentDefaults<TComponent>>(TComponent(std::forward<TArgs>(args)...));
+        return *this;
+    }
+
+    template <typename TComponent>
+    bool HasComponent() const {
+        const auto componentId = static_cast<std::size_t>(Component<TComponent>::GetId());
+        return componentId < components.size() && components[componentId];
+    }
+
+    // Used by `Registry::Instantiate`
+    void AddTo(Registry& registry, const std::vector<Entity>& entities) const {
+        for (const auto& component : components) {
+            if (component)
+                component->AddTo(registry, entities);
+        }
+    }
+};
+
+#endif  // PREFAB_H
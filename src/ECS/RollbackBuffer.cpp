@@ -0,0 +1,286 @@
+#include "RollbackBuffer.h"
+
+#include "Components/ComponentSerializers.h"
+#include "Timers/TimerService.h"
+
+#include <algorithm>
+#include <type_traits>
+
+RollbackBuffer::RollbackBuffer(std::size_t frames) : undos(frames > 1 ? frames - 1 : 0) {}
+
+void RollbackBuffer::Save(Registry& registry, const TimerService& timers, std::uint32_t frame) {
+    if (!hasLatest || frame != latestFrame + 1 || tracked != &registry) {
+        Clear();
+        CaptureAll(registry);
+        latest.time = timers.GetTime();
+        latestFrame = frame;
+        hasLatest = true;
+        return;
+    }
+
+    // Without older frames, the latest one still moves forward
+    Undo* undo = nullptr;
+    if (!undos.empty()) {
+        // The oldest frame makes room
+        if (count == undos.size()) {
+            first = (first + 1) % undos.size();
+            count--;
+        }
+        undo = &GetUndo(count);
+        count++;
+        undo->frame = latestFrame;
+        undo->time = latest.time;
+    }
+    CaptureChanges(registry, undo);
+    latest.time = timers.GetTime();
+    latestFrame = frame;
+}
+
+bool RollbackBuffer::Restore(Registry& registry, TimerService& timers, std::uint32_t frame) {
+    if (!Contains(frame) || tracked != &registry) {
+        spdlog::error("Frame {} is not in the rollback buffer", frame);
+        return false;
+    }
+
+    // Newest frame first, down to the frame
+    std::size_t kept = count;
+    while (kept > 0 && GetUndo(kept - 1).frame >= frame) {
+        ApplyUndo(GetUndo(kept - 1));
+        kept--;
+    }
+
+    // The frames after it are resimulated and saved again
+    count = kept;
+    latestFrame = frame;
+
+    // The registry gets copies, the latest state stays the base of the next saves
+    std::vector<std::shared_ptr<IPool>> pools(ComponentTypes::size);
+    ForEachType(ComponentTypes(), [this, &pools](auto* type) {
+        using TComponent = std::remove_pointer_t<decltype(type)>;
+        const auto componentId = Component<TComponent>::GetId();
+        pools[componentId] = CopyPool<TComponent>(latest.pools[componentId].get());
+    });
+    std::unordered_map<std::string, std::vector<Entity>> membership;
+    for (const auto& system : latest.membership)
+        membership.emplace(system.first, system.second.entities);
+
+    // The lifetimes are loaded on the clock of the frame
+    timers.SetTime(latest.time);
+    registry.ReplaceState(latest.entityCount, latest.signatures, std::move(pools), latest.dormant,
+                          latest.freeIds, membership);
+    SkipChanges(registry);
+    for (const auto& system : registry.systems)
+        latest.membership[system.first.name()].version = system.second->GetMembershipVersion();
+    return true;
+}
+
+bool RollbackBuffer::Contains(std::uint32_t frame) const {
+    return hasLatest && frame <= latestFrame && latestFrame - frame <= count;
+}
+
+std::size_t RollbackBuffer::GetMemoryUsage() const {
+    std::size_t bytes = latest.signatures.capacity() * sizeof(Signature) + latest.dormant.capacity()
+                        + latest.freeIds.capacity() * sizeof(int);
+    for (const auto& system : latest.membership)
+        bytes += system.second.entities.capacity() * sizeof(Entity);
+    ForEachType(ComponentTypes(), [this, &bytes](auto* type) {
+        using TComponent = std::remove_pointer_t<decltype(type)>;
+        const auto& pool = latest.pools[Component<TComponent>::GetId()];
+        if (pool)
+            bytes += static_cast<const Pool<TComponent>*>(pool.get())->GetSize() * sizeof(TComponent);
+    });
+
+    for (const auto& undo : undos) {
+        bytes += undo.entities.capacity() * sizeof(EntityState) + undo.freeIds.capacity() * sizeof(int);
+        for (const auto& system : undo.membership)
+            bytes += system.second.capacity() * sizeof(Entity);
+        for (const auto& slots : undo.components) {
+            if (slots)
+                bytes += slots->GetMemoryUsage();
+        }
+    }
+    return bytes;
+}
+
+void RollbackBuffer::Clear() {
+    first = 0;
+    count = 0;
+    hasLatest = false;
+}
+
+void RollbackBuffer::CaptureAll(Registry& registry) {
+    // The readers are added once, reading them moves them to now
+    if (tracked != &registry) {
+        tracked = &registry;
+        entityReader = registry.entityChangeLog.AddReader();
+        componentReaders.assign(ComponentTypes::size, -1);
+        ForEachType(ComponentTypes(), [this, &registry](auto* type) {
+            using TComponent = std::remove_pointer_t<decltype(type)>;
+            componentReaders[Component<TComponent>::GetId()] = registry.TrackChanges<TComponent>();
+        });
+    }
+    SkipChanges(registry);
+
+    const unsigned int entityCount = registry.numEntities;
+    latest.entityCount = entityCount;
+    latest.signatures.assign(registry.entityComponentSignatures.begin(),
+                             registry.entityComponentSignatures.begin() + entityCount);
+    latest.dormant.assign(registry.entityDormant.begin(), registry.entityDormant.begin() + entityCount);
+    latest.freeIds.assign(registry.freeIds.begin(), registry.freeIds.end());
+    latest.membership.clear();
+    for (const auto& system : registry.systems) {
+        latest.membership[system.first.name()] = { system.second->GetMembershipVersion(),
+                                                   system.second->GetSystemEntities() };
+    }
+
+    latest.pools.assign(ComponentTypes::size, nullptr);
+    ForEachType(ComponentTypes(), [this, &registry](auto* type) {
+        using TComponent = std::remove_pointer_t<decltype(type)>;
+        const auto componentId = Component<TComponent>::GetId();
+        latest.pools[componentId] = CopyPool<TComponent>(registry.componentPools[componentId].get());
+    });
+}
+
+void RollbackBuffer::CaptureChanges(Registry& registry, Undo* undo) {
+    const unsigned int entityCount = registry.numEntities;
+    if (undo) {
+        undo->entityCount = latest.entityCount;
+        undo->entities.clear();
+        undo->freeIdsChanged = false;
+        undo->membership.clear();
+        undo->components.resize(ComponentTypes::size);
+
+        // Ids past the new count, e.g. after loading a snapshot, aren't in the logs
+        for (unsigned int entityId = entityCount; entityId < latest.entityCount; entityId++)
+            undo->entities.push_back({ static_cast<int>(entityId), latest.signatures[entityId],
+                                       latest.dormant[entityId] != 0 });
+    }
+
+    // The writes from now on are in the next save
+    registry.TakeChangeTick();
+
+    // Signatures and activations, only of the entities logged
+    latest.entityCount = entityCount;
+    latest.signatures.resize(entityCount);
+    latest.dormant.resize(entityCount);
+    bool entitiesChanged = false;
+    auto captureEntity = [this, &registry, undo, &entitiesChanged](std::uint32_t tick, int entityId) {
+        const auto index = static_cast<std::size_t>(entityId);
+        if (index >= latest.entityCount || registry.entityChangeTicks[index] != tick)
+            return;
+
+        entitiesChanged = true;
+        if (undo && index < undo->entityCount)
+            undo->entities.push_back({ entityId, latest.signatures[index], latest.dormant[index] != 0 });
+        latest.signatures[index] = registry.entityComponentSignatures[index];
+        latest.dormant[index] = registry.entityDormant[index];
+    };
+    registry.entityChangeLog.Read(entityReader, captureEntity);
+
+    // Ids are only taken and freed with a logged entity
+    if (entitiesChanged && !std::equal(latest.freeIds.begin(), latest.freeIds.end(),
+                                       registry.freeIds.begin(), registry.freeIds.end())) {
+        if (undo) {
+            undo->freeIdsChanged = true;
+            undo->freeIds.assign(latest.freeIds.begin(), latest.freeIds.end());
+        }
+        latest.freeIds.assign(registry.freeIds.begin(), registry.freeIds.end());
+    }
+
+    // Only the systems entities joined or left
+    for (const auto& system : registry.systems) {
+        auto& membership = latest.membership[system.first.name()];
+        const std::uint32_t version = system.second->GetMembershipVersion();
+        if (membership.version == version)
+            continue;
+
+        if (undo)
+            undo->membership.emplace_back(system.first.name(), membership.entities);
+        membership.version = version;
+        membership.entities = system.second->GetSystemEntities();
+    }
+
+    ForEachType(ComponentTypes(), [this, &registry, undo](auto* type) {
+        CaptureComponents<std::remove_pointer_t<decltype(type)>>(registry, undo);
+    });
+}
+
+void RollbackBuffer::ApplyUndo(const Undo& undo) {
+    latest.time = undo.time;
+    latest.entityCount = undo.entityCount;
+    latest.signatures.resize(undo.entityCount);
+    latest.dormant.resize(undo.entityCount);
+    for (auto entity = undo.entities.rbegin(); entity != undo.entities.rend(); ++entity) {
+        latest.signatures[entity->id] = entity->signature;
+        latest.dormant[entity->id] = entity->dormant;
+    }
+    if (undo.freeIdsChanged)
+        latest.freeIds = undo.freeIds;
+    for (const auto& system : undo.membership)
+        latest.membership[system.first].entities = system.second;
+
+    ForEachType(ComponentTypes(), [this, &undo](auto* type) {
+        UndoComponents<std::remove_pointer_t<decltype(type)>>(undo);
+    });
+}
+
+void RollbackBuffer::SkipChanges(Registry& registry) {
+    registry.TakeChangeTick();
+    registry.entityChangeLog.Read(entityReader, [](std::uint32_t, int) {});
+    ForEachType(ComponentTypes(), [this, &registry](auto* type) {
+        using TComponent = std::remove_pointer_t<decltype(type)>;
+        const auto componentId = Component<TComponent>::GetId();
+        registry.GetPool<TComponent>().GetChangeLog().Read(componentReaders[componentId],
+                                                           [](std::uint32_t, int) {});
+    });
+}
+
+template <typename TComponent>
+void RollbackBuffer::CaptureComponents(Registry& registry, Undo* undo) {
+    const auto componentId = Component<TComponent>::GetId();
+    Slots<TComponent>* slots = nullptr;
+    if (undo) {
+        auto& erased = undo->components[componentId];
+        if (!erased)
+            erased = std::make_unique<Slots<TComponent>>();
+        slots = static_cast<Slots<TComponent>*>(erased.get());
+        slots->Clear();
+    }
+
+    auto& pool = registry.GetPool<TComponent>();
+    auto& copy = latest.pools[componentId];
+    if (!copy)
+        copy = std::make_shared<Pool<TComponent>>(0);
+    auto& latestPool = *static_cast<Pool<TComponent>*>(copy.get());
+
+    pool.ForEachChanged(componentReaders[componentId], [&pool, &latestPool, slots](int entityId) {
+        if (entityId >= latestPool.GetSize())
+            latestPool.Resize(std::max(entityId + 1, pool.GetSize()));
+        if (slots)
+            slots->values.emplace_back(entityId, latestPool.Get(entityId));
+        latestPool.Set(entityId, pool.Get(entityId));
+    });
+}
+
+template <typename TComponent>
+void RollbackBuffer::UndoComponents(const Undo& undo) {
+    const auto componentId = Component<TComponent>::GetId();
+    if (!undo.components[componentId])
+        return;
+
+    const auto& slots = static_cast<const Slots<TComponent>&>(*undo.components[componentId]);
+    const auto& values = slots.values;
+    auto& latestPool = *static_cast<Pool<TComponent>*>(latest.pools[componentId].get());
+    for (auto value = values.rbegin(); value != values.rend(); ++value)
+        latestPool.Set(value->first, value->second);
+}
+
+template <typename TComponent>
+std::shared_ptr<IPool> RollbackBuffer::CopyPool(const IPool* pool) {
+    if (!pool)
+        return nullptr;
+
+    auto copy = std::make_shared<Pool<TComponent>>(*static_cast<const Pool<TComponent>*>(pool));
+    copy->GetChangeLog().Reset(0);
+    return copy;
+}
@@ -0,0 +1,130 @@
+#ifndef ROLLBACKBUFFER_H
+#define ROLLBACKBUFFER_H
+
+#include "ECS.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Forward declaration
+class TimerService;
+
+// Registry state of the last N frames, for rollback netcode and replay debugging. The buffer
+// keeps a copy of the latest frame and, for each older one, the values its next frame
+// overwrote. Saving a frame reads the change logs of the registry, so it only copies the
+// component slots written since the previous save, the entities whose signature or activation
+// changed and the lists of the systems that entities joined or left: the cost follows what
+// changed, not the size of the world. Going back K frames puts the overwritten values back,
+// newest first, then loads the result into the registry. The TimerService clock is kept with
+// each frame, the lifetimes of the registry expire on it. A buffer follows one registry.
+class RollbackBuffer {
+    // Values of one component type
+    struct ISlots {
+        virtual ~ISlots() = default;
+        virtual void Clear() = 0;
+        virtual std::size_t GetMemoryUsage() const = 0;
+    };
+
+    template <typename TComponent>
+    struct Slots : ISlots {
+        std::vector<std::pair<int, TComponent>> values;  // (entity id, value)
+
+        void Clear() override { values.clear(); }
+        std::size_t GetMemoryUsage() const override {
+            return values.capacity() * sizeof(std::pair<int, TComponent>);
+        }
+    };
+
+    struct EntityState {
+        int id;
+        Signature signature;
+        bool dormant;
+    };
+
+    // Turns the state of `frame + 1` back into the state of `frame`
+    struct Undo {
+        std::uint32_t frame;
+        double time;  // TimerService clock of `frame`
+        unsigned int entityCount;
+        std::vector<EntityState> entities;
+        bool freeIdsChanged;
+        std::vector<int> freeIds;
+        std::vector<std::pair<std::string, std::vector<Entity>>> membership;  // (system, entities)
+        std::vector<std::unique_ptr<ISlots>> components;  // [ component id ]
+    };
+
+    struct Membership {
+        std::uint32_t version;  // see `System::GetMembershipVersion()`
+        std::vector<Entity> entities;
+    };
+
+    // The registry at `latestFrame`
+    struct State {
+        unsigned int entityCount = 0;
+        std::vector<Signature> signatures;
+        std::vector<std::uint8_t> dormant;
+        std::vector<int> freeIds;
+        std::unordered_map<std::string, Membership> membership;  // [ system type name ]
+        std::vector<std::shared_ptr<IPool>> pools;  // [ component id ]
+        double time = 0.0;
+    };
+
+    std::vector<Undo> undos;  // ring, oldest at `first`
+    std::size_t first = 0;
+    std::size_t count = 0;
+
+    State latest;
+    std::uint32_t latestFrame = 0;
+    bool hasLatest = false;
+
+    // Change log readers in the registry followed
+    const Registry* tracked = nullptr;
+    int entityReader = -1;
+    std::vector<int> componentReaders;  // [ component id ]
+
+public:
+    // Frames kept, the latest one included
+    explicit RollbackBuffer(std::size_t frames = 16);
+
+    // The frames follow each other, any other frame starts a new history. Taken between two
+    // `Registry::Update()` calls, like a snapshot.
+    void Save(Registry& registry, const TimerService& timers, std::uint32_t frame);
+
+    // Puts the registry back to `frame` and forgets the frames after it, so the game
+    // resimulates from there, with the timer clock of that frame. False when the frame isn't
+    // kept.
+    bool Restore(Registry& registry, TimerService& timers, std::uint32_t frame);
+
+    bool Contains(std::uint32_t frame) const;
+    std::uint32_t GetLatestFrame() const { return latestFrame; }
+    std::size_t GetFrameCount() const { return hasLatest ? count + 1 : 0; }
+    std::size_t GetMemoryUsage() const;
+
+    void Clear();
+
+private:
+    Undo& GetUndo(std::size_t index) { return undos[(first + index) % undos.size()]; }
+    const Undo& GetUndo(std::size_t index) const { return undos[(first + index) % undos.size()]; }
+
+    // The whole registry, the change logs are read up to now
+    void CaptureAll(Registry& registry);
+    // What changed since the previous capture, the overwritten values go to `undo` if any
+    void CaptureChanges(Registry& registry, Undo* undo);
+    void ApplyUndo(const Undo& undo);
+    // Skips the changes made by loading the latest state into the registry
+    void SkipChanges(Registry& registry);
+
+    template <typename TComponent>
+    void CaptureComponents(Registry& registry, Undo* undo);
+    template <typename TComponent>
+    void UndoComponents(const Undo& undo);
+    template <typename TComponent>
+    static std::shared_ptr<IPool> CopyPool(const IPool* pool);
+};
+
+#endif  // ROLLBACKBUFFER_H
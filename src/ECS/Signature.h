@@ -0,0 +1,77 @@
+#ifndef SIGNATURE_H
+#define SIGNATURE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIGNATURE_SSE2
+#endif
+
+// Bit set of component ids, like `std::bitset` but of any multiple of 128 bits and with a
+// subset test done 128 bits at a time
+template <std::size_t BITS>
+class alignas(16) BasicSignature {
+    static_assert(BITS > 0 && BITS % 128 == 0, "Signatures are made of 128 bit lanes");
+
+    static constexpr std::size_t WORDS = BITS / 64;
+    std::array<std::uint64_t, WORDS> words = {};
+
+public:
+    static constexpr std::size_t size() { return BITS; }
+
+    BasicSignature& set(std::size_t bit, bool value = true) {
+        const std::uint64_t mask = std::uint64_t(1) << (bit % 64);
+        if (value)
+            words[bit / 64] |= mask;
+        else
+            words[bit / 64] &= ~mask;
+        return *this;
+    }
+
+    BasicSignature& reset() {
+        words.fill(0);
+        return *this;
+    }
+
+    bool test(std::size_t bit) const {
+        return (words[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    // True when every bit of `other` is set, e.g. the entity has the components of a system
+    bool Contains(const BasicSignature& other) const {
+#ifdef SIGNATURE_SSE2
+        __m128i missing = _mm_setzero_si128();
+        for (std::size_t i = 0; i < WORDS; i += 2) {
+            const auto mine = _mm_load_si128(reinterpret_cast<const __m128i*>(&words[i]));
+            const auto required = _mm_load_si128(reinterpret_cast<const __m128i*>(&other.words[i]));
+            missing = _mm_or_si128(missing, _mm_andnot_si128(mine, required));
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#else
+        std::uint64_t missing = 0;
+        for (std::size_t i = 0; i < WORDS; i++)
+            missing |= other.words[i] & ~words[i];
+        return missing == 0;
+#endif
+    }
+
+    BasicSignature operator&(const BasicSignature& other) const {
+        BasicSignature result;
+        for (std::size_t i = 0; i < WORDS; i++)
+            result.words[i] = words[i] & other.words[i];
+        return result;
+    }
+
+    bool operator==(const BasicSignature& other) const {
+        return words == other.words;
+    }
+
+    bool operator!=(const BasicSignature& other) const {
+        return words != other.words;
+    }
+};
+
+#endif  // SIGNATURE_H
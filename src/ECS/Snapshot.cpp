@@ -0,0 +1,266 @@
+#include "Snapshot.h"
+
+#include "Components/ComponentSerializers.h"
+#include "ECS.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+    constexpr std::uint32_t SNAPSHOT_MAGIC = 0x53534345;  // "ECSS"
+    constexpr std::uint32_t SNAPSHOT_VERSION = 3;
+}  // namespace
+
+template <typename TComponent>
+void Registry::SaveComponents(SnapshotWriter& writer) const {
+    const auto componentId = Component<TComponent>::GetId();
+    const auto* pool = componentId < static_cast<int>(componentPools.size())
+                           ? static_cast<const Pool<TComponent>*>(componentPools[componentId].get())
+                           : nullptr;
+    if (!pool) {
+        writer.Write(std::uint8_t(0));
+        return;
+    }
+
+    // Pools grow on demand, the slots past the last entity are not needed
+    const auto size = std::min(static_cast<unsigned int>(pool->GetSize()), numEntities);
+    writer.Write(std::uint8_t(1));
+    writer.Write(static_cast<std::uint32_t>(size));
+
+    if constexpr (std::is_trivially_copyable<TComponent>::value) {
+        writer.Write(pool->GetData(), size * sizeof(TComponent));
+    } else {
+        for (unsigned int entityId = 0; entityId < size; entityId++) {
+            if (entityComponentSignatures[entityId].test(componentId))
+                ComponentSerializer<TComponent>::Write(writer, pool->GetData()[entityId]);
+        }
+    }
+}
+
+template <typename TComponent>
+bool Registry::LoadComponents(SnapshotReader& reader, const std::vector<Signature>& signatures,
+                              std::vector<std::shared_ptr<IPool>>& pools) const {
+    const auto componentId = Component<TComponent>::GetId();
+
+    std::uint8_t present = 0;
+    std::uint32_t size = 0;
+    if (!reader.Read(present) || (present && !reader.Read(size)) || size > signatures.size())
+        return false;
+    const bool bulk = std::is_trivially_copyable<TComponent>::value;
+    if (bulk && size > reader.GetRemaining() / sizeof(TComponent))
+        return false;
+
+    // Every entity with the component has a slot in the pool
+    for (std::size_t entityId = size; entityId < signatures.size(); entityId++) {
+        if (signatures[entityId].test(componentId))
+            return false;
+    }
+    if (!present)
+        return true;
+
+    auto pool = std::make_shared<Pool<TComponent>>(size);
+    if constexpr (std::is_trivially_copyable<TComponent>::value) {
+        reader.Read(pool->GetData(), size * sizeof(TComponent));
+    } else {
+        for (std::uint32_t entityId = 0; entityId < size; entityId++) {
+            if (signatures[entityId].test(componentId))
+                ComponentSerializer<TComponent>::Read(reader, pool->GetData()[entityId]);
+        }
+    }
+    pools[componentId] = pool;
+    return !reader.HasFailed();
+}
+
+// Layout, every count before its items:
+//   header: magic, version, signature bits, component types, entities
+//   signatures and dormant flags [ index = entity id ], free ids
+//   per component type, in `ComponentTypes` order: pool or nothing
+//   per system: type name, entities in system order
+void Registry::SaveSnapshot(std::vector<std::uint8_t>& snapshot) const {
+    if (!entitiesToBeAdded.empty() || !entitiesToBeKilled.empty() || !batchToBeAdded.empty())
+        spdlog::warn("The snapshot leaves out the entities waiting for the next update");
+
+    snapshot.clear();
+    snapshot.reserve(numEntities * (sizeof(Signature) + 1));
+    SnapshotWriter writer(snapshot);
+
+    writer.Write(SNAPSHOT_MAGIC);
+    writer.Write(SNAPSHOT_VERSION);
+    writer.Write(static_cast<std::uint32_t>(MAX_COMPONENTS));
+    writer.Write(static_cast<std::uint32_t>(ComponentTypes::size));
+    writer.Write(static_cast<std::uint32_t>(numEntities));
+
+    writer.Write(entityComponentSignatures.data(), numEntities * sizeof(Signature));
+    std::vector<std::uint8_t> dormant(numEntities);
+    for (unsigned int entityId = 0; entityId < numEntities; entityId++)
+        dormant[entityId] = entityDormant[entityId];
+    writer.Write(dormant.data(), dormant.size());
+
+    const std::vector<int> free(freeIds.begin(), freeIds.end());
+    writer.Write(static_cast<std::uint32_t>(free.size()));
+    writer.Write(free.data(), free.size() * sizeof(int));
+
+    ForEachType(ComponentTypes(), [this, &writer](auto* type) {
+        SaveComponents<std::remove_pointer_t<decltype(type)>>(writer);
+    });
+
+    // Keyed by type name, the same in every run of a build
+    writer.Write(static_cast<std::uint32_t>(systems.size()));
+    std::vector<int> ids;
+    for (const auto& system : systems) {
+        const auto& entities = system.second->GetSystemEntities();
+        ids.resize(entities.size());
+        for (std::size_t i = 0; i < entities.size(); i++)
+            ids[i] = entities[i].GetId();
+        writer.WriteString(system.first.name());
+        writer.Write(static_cast<std::uint32_t>(ids.size()));
+        writer.Write(ids.data(), ids.size() * sizeof(int));
+    }
+
+    spdlog::debug("Saved a snapshot of {} entities, {} bytes", numEntities, snapshot.size());
+}
+
+bool Registry::LoadSnapshot(const std::vector<std::uint8_t>& snapshot) {
+    SnapshotReader reader(snapshot);
+
+    std::uint32_t magic = 0;
+    std::uint32_t version = 0;
+    std::uint32_t signatureBits = 0;
+    std::uint32_t componentTypes = 0;
+    std::uint32_t entityCount = 0;
+    reader.Read(magic);
+    reader.Read(version);
+    reader.Read(signatureBits);
+    reader.Read(componentTypes);
+    reader.Read(entityCount);
+    if (reader.HasFailed() || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION ||
+        signatureBits != MAX_COMPONENTS || componentTypes != ComponentTypes::size) {
+        spdlog::error("The snapshot is not from this build");
+        return false;
+    }
+
+    // Everything is read and checked before the registry is touched
+    std::vector<Signature> signatures;
+    std::vector<std::uint8_t> dormant;
+    if (entityCount <= reader.GetRemaining() / (sizeof(Signature) + 1)) {
+        signatures.resize(entityCount);
+        dormant.resize(entityCount);
+        reader.Read(signatures.data(), entityCount * sizeof(Signature));
+        reader.Read(dormant.data(), entityCount);
+    } else {
+        reader.Fail();
+    }
+
+    std::uint32_t freeCount = 0;
+    std::vector<int> free;
+    if (reader.Read(freeCount) && freeCount <= reader.GetRemaining() / sizeof(int)) {
+        free.resize(freeCount);
+        reader.Read(free.data(), freeCount * sizeof(int));
+    } else {
+        reader.Fail();
+    }
+    for (const int entityId : free) {
+        if (entityId < 0 || static_cast<std::uint32_t>(entityId) >= entityCount)
+            reader.Fail();
+    }
+
+    std::vector<std::shared_ptr<IPool>> pools(ComponentTypes::size);
+    ForEachType(ComponentTypes(), [this, &reader, &signatures, &pools](auto* type) {
+        if (!LoadComponents<std::remove_pointer_t<decltype(type)>>(reader, signatures, pools))
+            reader.Fail();
+    });
+
+    std::uint32_t systemCount = 0;
+    reader.Read(systemCount);
+    std::unordered_map<std::string, std::vector<Entity>> membership;
+    std::vector<int> ids;
+    for (std::uint32_t i = 0; i < systemCount && !reader.HasFailed(); i++) {
+        std::string name;
+        std::uint32_t count = 0;
+        reader.ReadString(name);
+        if (!reader.Read(count) || count > reader.GetRemaining() / sizeof(int)) {
+            reader.Fail();
+            break;
+        }
+        ids.resize(count);
+        reader.Read(ids.data(), count * sizeof(int));
+
+        auto& entities = membership[name];
+        entities.reserve(count);
+        for (const int entityId : ids) {
+            if (entityId < 0 || static_cast<std::uint32_t>(entityId) >= entityCount)
+                reader.Fail();
+            entities.emplace_back(entityId);
+            entities.back().registry = this;
+        }
+    }
+
+    if (reader.HasFailed()) {
+        spdlog::error("The snapshot is damaged");
+        return false;
+    }
+
+    ReplaceState(entityCount, std::move(signatures), std::move(pools), dormant, free, membership);
+    spdlog::debug("Loaded a snapshot of {} entities", numEntities);
+    return true;
+}
+
+void Registry::ReplaceState(unsigned int entityCount, std::vector<Signature> signatures,
+                            std::vector<std::shared_ptr<IPool>> pools,
+                            const std::vector<std::uint8_t>& dormant, const std::vector<int>& free,
+                            const std::unordered_map<std::string, std::vector<Entity>>& membership) {
+    // The systems let go of their entities while the components are still there
+    for (auto& system : systems) {
+        std::vector<Entity> entities = system.second->GetSystemEntities();
+        std::sort(entities.begin(), entities.end());
+        system.second->RemoveEntitiesFromSystem(entities);
+    }
+
+    numEntities = entityCount;
+    entityComponentSignatures = std::move(signatures);
+    componentPools = std::move(pools);
+    entityDormant.assign(dormant.begin(), dormant.end());
+    entityToggled.assign(numEntities, false);
+    freeIds.assign(free.begin(), free.end());
+    entityAlive.assign(numEntities, true);
+    for (const int entityId : free)
+        entityAlive[entityId] = false;
+    entitiesToBeAdded.clear();
+    entitiesToBeKilled.clear();
+    batchToBeAdded.clear();
+    entitiesToBeToggled.clear();
+
+    // Everything put in place counts as changed, the change log readers start over
+    for (std::size_t componentId = 0; componentId < componentPools.size(); componentId++) {
+        if (!componentPools[componentId])
+            continue;
+        componentPools[componentId]->GetChangeLog().Reset(
+            componentId < changeReaders.size() ? changeReaders[componentId] : 0);
+        componentPools[componentId]->MarkAllChanged(changeTick);
+    }
+    entityChangeLog.Reset(entityChangeLog.GetReaderCount());
+    entityChangeTicks.clear();
+    for (unsigned int entityId = 0; entityId < numEntities; entityId++)
+        MarkEntityChanged(entityId);
+
+    // In system order, the systems see the dormant entities join as dormant. A system
+    // missing from `membership` takes its entities by id.
+    for (auto& system : systems) {
+        const auto saved = membership.find(system.first.name());
+        if (saved != membership.end()) {
+            system.second->AddEntitiesToSystem(saved->second);
+            continue;
+        }
+
+        const auto& systemComponentSignature = system.second->GetComponentSignature();
+        systemBatch.clear();
+        for (unsigned int entityId = 0; entityId < numEntities; entityId++) {
+            if (entityComponentSignatures[entityId].Contains(systemComponentSignature)) {
+                systemBatch.emplace_back(entityId);
+                systemBatch.back().registry = this;
+            }
+        }
+        system.second->AddEntitiesToSystem(systemBatch);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Appends the bytes of a registry snapshot, see `Registry::SaveSnapshot`
+class SnapshotWriter {
+    std::vector<std::uint8_t>* buffer;
+
+public:
+    explicit SnapshotWriter(std::vector<std::uint8_t>& buffer) : buffer(&buffer) {}
+
+    void Write(const void* data, std::size_t size) {
+        const std::size_t offset = buffer->size();
+        buffer->resize(offset + size);
+        if (size > 0)
+            std::memcpy(buffer->data() + offset, data, size);
+    }
+
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Values are written as bytes");
+        Write(&value, sizeof(T));
+    }
+
+    void WriteString(const std::string& text) {
+        Write(static_cast<std::uint32_t>(text.size()));
+        Write(text.data(), text.size());
+    }
+};
+
+// Reads a snapshot back. Reading past the end fails, and every read after it fails too, so
+// the result can be checked once at the end.
+class SnapshotReader {
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t offset = 0;
+    bool failed = false;
+
+public:
+    explicit SnapshotReader(const std::vector<std::uint8_t>& buffer)
+        : data(buffer.data()), size(buffer.size()) {}
+
+    bool Read(void* output, std::size_t count) {
+        if (failed || count > size - offset) {
+            failed = true;
+            return false;
+        }
+        if (count > 0)
+            std::memcpy(output, data + offset, count);
+        offset += count;
+        return true;
+    }
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Values are read as bytes");
+        return Read(&value, sizeof(T));
+    }
+
+    bool ReadString(std::string& text) {
+        std::uint32_t length = 0;
+        if (!Read(length) || length > size - offset) {
+            failed = true;
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return true;
+    }
+
+    // For the values that are read but make no sense
+    void Fail() { failed = true; }
+
+    // Bytes left, e.g. to check a count before allocating for it
+    std::size_t GetRemaining() const { return failed ? 0 : size - offset; }
+    bool HasFailed() const { return failed; }
+};
+
+// How the components of a type are saved. Pools of trivially copyable components are copied
+// as a whole, the other types specialize this with
+//     static void Write(SnapshotWriter& writer, const TComponent& component);
+//     static void Read(SnapshotReader& reader, TComponent& component);
+template <typename TComponent>
+struct ComponentSerializer {
+    static_assert(std::is_trivially_copyable<TComponent>::value,
+                  "Specialize ComponentSerializer for components that aren't trivially copyable");
+};
+
+#endif  // SNAPSHOT_H
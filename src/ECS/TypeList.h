@@ -0,0 +1,30 @@
+#ifndef TYPELIST_H
+#define TYPELIST_H
+
+#include <cstddef>
+#include <type_traits>
+
+// A list of types known at compile time, e.g. every component type
+template <typename... Types>
+struct TypeList {
+    static constexpr std::size_t size = sizeof...(Types);
+};
+
+// Position of `T` in the list, -1 when it isn't in it
+template <typename T, typename... Types>
+constexpr int IndexOf(TypeList<Types...>) {
+    constexpr bool matches[] = { std::is_same<T, Types>::value..., false };
+    for (std::size_t i = 0; i < sizeof...(Types); i++) {
+        if (matches[i])
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Calls `function(static_cast<T*>(nullptr))` for every type of the list, in order
+template <typename... Types, typename TFunction>
+void ForEachType(TypeList<Types...>, TFunction&& function) {
+    (function(static_cast<Types*>(nullptr)), ...);
+}
+
+#endif  // TYPELIST_H
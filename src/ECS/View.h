@@ -0,0 +1,105 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include "ECS.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// Term of a `View`: requires T and keeps only the entities whose T changed since the view's tick
+template <typename TComponent>
+struct Changed {};
+
+template <typename TTerm>
+struct ViewTerm {
+    using Component = TTerm;
+    static constexpr bool changed = false;
+};
+
+template <typename TComponent>
+struct ViewTerm<Changed<TComponent>> {
+    using Component = TComponent;
+    static constexpr bool changed = true;
+};
+
+// The entities having every component of `TTerms`, in id order, e.g.
+//   for (Entity entity : View<SpriteComponent, Changed<TransformComponent>>(registry, since))
+// `since` is a tick from `Registry::TakeChangeTick()`, 0 takes every component as changed.
+// Dormant entities are left out like in the systems, the entities created during the
+// iteration are not visited.
+template <typename... TTerms>
+class View {
+    static_assert(sizeof...(TTerms) > 0, "A view needs at least one component");
+
+    Registry* registry;
+    Signature signature;
+    std::uint32_t since;
+    unsigned int size;
+
+public:
+    class Iterator {
+        const View* view;
+        unsigned int entityId;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entity;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entity*;
+        using reference = Entity;
+
+        Iterator(const View* view, unsigned int entityId)
+            : view(view), entityId(view->Next(entityId)) {}
+
+        Entity operator*() const {
+            Entity entity(entityId);
+            entity.registry = view->registry;
+            return entity;
+        }
+
+        Iterator& operator++() {
+            entityId = view->Next(entityId + 1);
+            return *this;
+        }
+
+        bool operator==(const Iterator& other) const { return entityId == other.entityId; }
+        bool operator!=(const Iterator& other) const { return entityId != other.entityId; }
+    };
+
+    explicit View(Registry& registry, std::uint32_t since = 0)
+        : registry(&registry), since(since), size(registry.numEntities) {
+        (signature.set(Component<typename ViewTerm<TTerms>::Component>::GetId()), ...);
+    }
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size); }
+
+private:
+    // The first matching entity from `entityId` on, `size` when none
+    unsigned int Next(unsigned int entityId) const {
+        while (entityId < size && !Matches(entityId))
+            entityId++;
+        return entityId;
+    }
+
+    bool Matches(unsigned int entityId) const {
+        if (registry->entityDormant[entityId] ||
+            !registry->entityComponentSignatures[entityId].Contains(signature))
+            return false;
+
+        Entity entity(entityId);
+        entity.registry = registry;
+        return (Passes<TTerms>(entity) && ...);
+    }
+
+    template <typename TTerm>
+    bool Passes(Entity entity) const {
+        if constexpr (ViewTerm<TTerm>::changed)
+            return registry->HasChanged<typename ViewTerm<TTerm>::Component>(entity, since);
+        else
+            return true;
+    }
+};
+
+#endif  // VIEW_H
@@ -0,0 +1,90 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "ECS.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Opts a stage out of the passes with `TContext`, e.g. the render system out of the update
+// pass or a system that only reacts to events. Every other stage needs a
+// `TickStage(stage, context)` overload, a missing or mistyped one doesn't compile.
+template <typename TStage, typename TContext>
+struct SkipsTick : std::false_type {};
+
+template <typename TStage, typename TContext, typename = void>
+struct HasTickStage : std::false_type {};
+
+template <typename TStage, typename TContext>
+struct HasTickStage<TStage, TContext,
+                    std::void_t<decltype(TickStage(std::declval<TStage&>(), std::declval<TContext&>()))>>
+    : std::true_type {};
+
+// A pipeline fixed at compile time. `TStages` are ticked in order, each through the
+// `TickStage(stage, context)` overload for its type, so every call is resolved at compile time
+// and can be inlined. Stages deriving from `System` are owned by the registry, which keeps
+// their entities up to date, the world only keeps a typed pointer to them. The other stages
+// are plain objects owned by the world, e.g. "deliver the events".
+template <typename... TStages>
+class World {
+    template <typename TStage>
+    using Slot = std::conditional_t<std::is_base_of<System, TStage>::value, TStage*, TStage>;
+
+    Registry* registry;
+    std::tuple<Slot<TStages>...> stages;
+
+public:
+    explicit World(Registry& registry) : registry(&registry), stages() {}
+
+    // Adds the system to the registry, systems not added are skipped by `Tick`
+    template <typename TSystem, typename... TArgs>
+    TSystem& AddSystem(TArgs&&... args) {
+        registry->AddSystem<TSystem>(std::forward<TArgs>(args)...);
+        std::get<TSystem*>(stages) = &registry->GetSystem<TSystem>();
+        return *std::get<TSystem*>(stages);
+    }
+
+    // No hashing, unlike `Registry::GetSystem`
+    template <typename TSystem>
+    TSystem& GetSystem() const {
+        static_assert(std::is_base_of<System, TSystem>::value, "Not a system");
+        return *std::get<TSystem*>(stages);
+    }
+
+    template <typename TStage>
+    TStage& GetStage() {
+        static_assert(!std::is_base_of<System, TStage>::value, "Systems are got with GetSystem");
+        return std::get<TStage>(stages);
+    }
+
+    Registry& GetRegistry() const { return *registry; }
+
+    // One pass of the pipeline
+    template <typename TContext>
+    void Tick(TContext& context) {
+        (TickSlot(std::get<Slot<TStages>>(stages), context), ...);
+    }
+
+private:
+    template <typename TSystem, typename TContext>
+    static void TickSlot(TSystem* system, TContext& context) {
+        if (system)
+            TickSlot(*system, context);
+    }
+
+    template <typename TStage, typename TContext>
+    static void TickSlot(TStage& stage, TContext& context) {
+        if constexpr (SkipsTick<TStage, TContext>::value) {
+            static_assert(!HasTickStage<TStage, TContext>::value,
+                          "The stage has a TickStage overload for a pass it skips");
+        } else if constexpr (HasTickStage<TStage, TContext>::value) {
+            TickStage(stage, context);
+        } else {
+            static_assert(HasTickStage<TStage, TContext>::value,
+                          "No TickStage(stage, context) overload, specialize SkipsTick to skip the pass");
+        }
+    }
+};
+
+#endif  // WORLD_H
@@ -0,0 +1,152 @@
+#include "EventBus.h"
+
+#include <algorithm>
+#include <utility>
+
+// Initializes static methods from header
+std::atomic<int> IEvent::nextId{ 0 };
+
+namespace {
+    // Events of a type in a fresh queue, the queue doubles from there
+    constexpr std::size_t MIN_QUEUE_CAPACITY = 64;
+
+    std::atomic<std::uint64_t> nextBusSerial{ 1 };
+}  // namespace
+
+EventBus::EventBus() : serial(nextBusSerial++) {}
+
+EventBus::~EventBus() = default;
+
+void EventBus::Unsubscribe(SubscriptionId subscription) {
+    for (auto& typeSubscribers : subscribers) {
+        for (auto it = typeSubscribers.begin(); it != typeSubscribers.end(); ++it) {
+            if (it->id != subscription)
+                continue;
+
+            // The list is being walked and the callback may be the one running, it's only
+            // skipped and the list is compacted after the dispatch
+            if (dispatching)
+                it->active = false;
+            else
+                typeSubscribers.erase(it);
+            return;
+        }
+    }
+
+    // Subscribed during this dispatch, not walked yet
+    const auto added = [subscription](const AddedSubscriber& item) { return item.subscriber.id == subscription; };
+    addedSubscribers.erase(std::remove_if(addedSubscribers.begin(), addedSubscribers.end(), added),
+                           addedSubscribers.end());
+}
+
+void EventBus::AddSubscriber(std::size_t typeId, Subscriber&& subscriber) {
+    if (typeId >= subscribers.size())
+        subscribers.resize(typeId + 1);
+    subscribers[typeId].push_back(std::move(subscriber));
+}
+
+void EventBus::Dispatch() {
+    // A subscriber can't dispatch, its events wait for the next dispatch anyway
+    if (dispatching)
+        return;
+
+    MergeThreadQueues();
+
+    // The events published by the subscribers meanwhile wait for the next dispatch
+    std::swap(pending, delivering);
+
+    dispatching = true;
+    for (std::size_t typeId = 0; typeId < delivering.queues.size(); typeId++) {
+        const Queue& queue = delivering.queues[typeId];
+        if (queue.size == 0 || typeId >= subscribers.size())
+            continue;
+
+        // Subscribers added during the dispatch wait in `addedSubscribers`, the list is stable
+        for (const auto& subscriber : subscribers[typeId]) {
+            if (subscriber.active)
+                subscriber.callback(queue.data, queue.size);
+        }
+    }
+    dispatching = false;
+
+    for (auto& typeSubscribers : subscribers) {
+        const auto unsubscribed = [](const Subscriber& subscriber) { return !subscriber.active; };
+        typeSubscribers.erase(
+            std::remove_if(typeSubscribers.begin(), typeSubscribers.end(), unsubscribed),
+            typeSubscribers.end());
+    }
+    for (auto& added : addedSubscribers)
+        AddSubscriber(added.typeId, std::move(added.subscriber));
+    addedSubscribers.clear();
+    delivering.Clear();
+}
+
+EventBus::EventQueues& EventBus::GetThreadQueues() {
+    // Most threads only ever publish to one bus, the cache is searched linearly
+    thread_local std::vector<std::pair<std::uint64_t, EventQueues*>> cache;
+    for (const auto& [busSerial, queues] : cache) {
+        if (busSerial == serial)
+            return *queues;
+    }
+
+    std::lock_guard<std::mutex> lock(threadQueuesMutex);
+    threadQueues.push_back(std::make_unique<EventQueues>());
+    cache.emplace_back(serial, threadQueues.back().get());
+    return *threadQueues.back();
+}
+
+void EventBus::MergeThreadQueues() {
+    std::lock_guard<std::mutex> lock(threadQueuesMutex);
+    for (auto& queues : threadQueues) {
+        for (std::size_t typeId = 0; typeId < queues->queues.size(); typeId++) {
+            const Queue& source = queues->queues[typeId];
+            if (source.size == 0)
+                continue;
+
+            Queue& target =
+                pending.Get(static_cast<int>(typeId), source.eventSize, source.eventAlignment);
+            std::memcpy(pending.Append(target, source.size), source.data,
+                        source.size * source.eventSize);
+        }
+        queues->Clear();
+    }
+}
+
+EventBus::Queue& EventBus::EventQueues::Get(int typeId, std::size_t eventSize,
+                                            std::size_t eventAlignment) {
+    const auto index = static_cast<std::size_t>(typeId);
+    if (index >= queues.size())
+        queues.resize(index + 1);
+
+    Queue& queue = queues[index];
+    queue.eventSize = eventSize;
+    queue.eventAlignment = eventAlignment;
+    return queue;
+}
+
+std::byte* EventBus::EventQueues::Append(Queue& queue, std::size_t count) {
+    // Growing leaves the old copy in the arena until the reset, at most as much as the queue itself
+    if (queue.size + count > queue.capacity) {
+        const std::size_t capacity =
+            std::max({ MIN_QUEUE_CAPACITY, queue.capacity * 2, queue.size + count });
+        void* memory = arena.Allocate(capacity * queue.eventSize, queue.eventAlignment);
+        auto* data = static_cast<std::byte*>(memory);
+        if (queue.size > 0)
+            std::memcpy(data, queue.data, queue.size * queue.eventSize);
+        queue.data = data;
+        queue.capacity = capacity;
+    }
+
+    std::byte* end = queue.data + queue.size * queue.eventSize;
+    queue.size += count;
+    return end;
+}
+
+void EventBus::EventQueues::Clear() {
+    for (auto& queue : queues) {
+        queue.data = nullptr;
+        queue.size = 0;
+        queue.capacity = 0;
+    }
+    arena.Reset();
+}
@@ -0,0 +1,173 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include "FrameArena.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//------------------------------------------------------------------------
+// Event types
+//------------------------------------------------------------------------
+struct IEvent {
+protected:
+    static std::atomic<int> nextId;
+};
+
+// Assigns a unique id to an event type, in first use order
+template <typename T>
+class EventType : public IEvent {
+public:
+    static int GetId() {
+        static const int id = nextId++;
+        return id;
+    }
+};
+
+// Events of one type handed to a subscriber at once, valid during the call only
+template <typename TEvent>
+struct EventBatch {
+    const TEvent* data;
+    std::size_t count;
+
+    const TEvent* begin() const { return data; }
+    const TEvent* end() const { return data + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const TEvent& operator[](std::size_t index) const { return data[index]; }
+};
+
+//------------------------------------------------------------------------
+// Event bus
+//------------------------------------------------------------------------
+// Events are copied into one contiguous queue per type, allocated in a frame arena, and
+// handed to the subscribers in batches when `Dispatch` is called at fixed points of the
+// game loop. Events published by the subscribers during a dispatch go to the next one, and
+// so do the subscriptions they make. A subscriber may unsubscribe itself or others during a
+// dispatch, the lists are only compacted once it's over.
+// Worker threads publish with `PublishFromThread` into queues of their own, which are
+// merged at the next dispatch, so the workers have to be done by then.
+class EventBus {
+public:
+    using SubscriptionId = std::uint32_t;
+
+    EventBus();
+    ~EventBus();
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    template <typename TEvent, typename TCallback>
+    SubscriptionId Subscribe(TCallback&& callback);
+    void Unsubscribe(SubscriptionId subscription);
+
+    // Main thread only
+    template <typename TEvent>
+    void Publish(const TEvent& event);
+    template <typename TEvent>
+    void Publish(const TEvent* events, std::size_t count);
+
+    // Any thread, between two dispatches
+    template <typename TEvent>
+    void PublishFromThread(const TEvent& event);
+
+    // Delivers the queued events type by type, in subscription order, then frees the queues
+    void Dispatch();
+
+private:
+    // Type erased queue of events of one type
+    struct Queue {
+        std::byte* data = nullptr;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+        std::size_t eventSize = 0;
+        std::size_t eventAlignment = 1;
+    };
+
+    struct EventQueues {
+        FrameArena arena;
+        std::vector<Queue> queues;  // [ event type id ]
+
+        Queue& Get(int typeId, std::size_t eventSize, std::size_t eventAlignment);
+        std::byte* Append(Queue& queue, std::size_t count);
+        void Clear();
+    };
+
+    struct Subscriber {
+        SubscriptionId id;
+        std::function<void(const void*, std::size_t)> callback;  // may be running, never reassigned
+        bool active;  // false once unsubscribed during a dispatch
+    };
+
+    struct AddedSubscriber {
+        std::size_t typeId;
+        Subscriber subscriber;
+    };
+
+    EventQueues pending;
+    EventQueues delivering;
+    std::vector<std::vector<Subscriber>> subscribers;  // [ event type id ]
+    std::vector<AddedSubscriber> addedSubscribers;  // during a dispatch, joined after it
+    SubscriptionId nextSubscription = 1;
+    bool dispatching = false;
+
+    // Queues of the worker threads, they live as long as the bus
+    std::mutex threadQueuesMutex;
+    std::vector<std::unique_ptr<EventQueues>> threadQueues;
+    const std::uint64_t serial;  // tells the buses apart in the thread local cache
+
+    EventQueues& GetThreadQueues();
+    void MergeThreadQueues();
+    void AddSubscriber(std::size_t typeId, Subscriber&& subscriber);
+};
+
+template <typename TEvent, typename TCallback>
+EventBus::SubscriptionId EventBus::Subscribe(TCallback&& callback) {
+    const auto typeId = static_cast<std::size_t>(EventType<TEvent>::GetId());
+    const SubscriptionId id = nextSubscription++;
+    auto erased = [callback = std::forward<TCallback>(callback)](const void* events,
+                                                                  std::size_t count) mutable {
+        callback(EventBatch<TEvent>{ static_cast<const TEvent*>(events), count });
+    };
+
+    // The lists walked by a dispatch never grow under it
+    if (dispatching)
+        addedSubscribers.push_back({ typeId, { id, std::move(erased), true } });
+    else
+        AddSubscriber(typeId, { id, std::move(erased), true });
+    return id;
+}
+
+template <typename TEvent>
+void EventBus::Publish(const TEvent& event) {
+    Publish(&event, 1);
+}
+
+template <typename TEvent>
+void EventBus::Publish(const TEvent* events, std::size_t count) {
+    static_assert(std::is_trivially_copyable<TEvent>::value, "Events are copied as bytes");
+    if (count == 0)
+        return;
+
+    Queue& queue = pending.Get(EventType<TEvent>::GetId(), sizeof(TEvent), alignof(TEvent));
+    std::memcpy(pending.Append(queue, count), events, count * sizeof(TEvent));
+}
+
+template <typename TEvent>
+void EventBus::PublishFromThread(const TEvent& event) {
+    static_assert(std::is_trivially_copyable<TEvent>::value, "Events are copied as bytes");
+
+    EventQueues& queues = GetThreadQueues();
+    Queue& queue = queues.Get(EventType<TEvent>::GetId(), sizeof(TEvent), alignof(TEvent));
+    std::memcpy(queues.Append(queue, 1), &event, sizeof(TEvent));
+}
+
+#endif  // EVENTBUS_H
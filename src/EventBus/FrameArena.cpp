@@ -0,0 +1,44 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(std::size_t blockSize) : blockSize(std::max<std::size_t>(blockSize, 1024)) {}
+
+void* FrameArena::Allocate(std::size_t size, std::size_t alignment) {
+    if (!blocks.empty()) {
+        auto& block = blocks.back();
+        const auto address = reinterpret_cast<std::uintptr_t>(block.data.get()) + used;
+        const std::size_t padding = (alignment - address % alignment) % alignment;
+        if (used + padding + size <= block.size) {
+            used += padding + size;
+            return block.data.get() + used - size;
+        }
+    }
+
+    // A new block, `new[]` aligns it for any fundamental type
+    const std::size_t newSize = std::max(blockSize, size + alignment);
+    blocks.push_back({ std::make_unique<std::byte[]>(newSize), newSize });
+    auto& block = blocks.back();
+    const auto address = reinterpret_cast<std::uintptr_t>(block.data.get());
+    const std::size_t padding = (alignment - address % alignment) % alignment;
+    used = padding + size;
+    return block.data.get() + padding;
+}
+
+void FrameArena::Reset() {
+    used = 0;
+    if (blocks.size() <= 1)
+        return;
+
+    const std::size_t capacity = GetCapacity();
+    blocks.clear();
+    blocks.push_back({ std::make_unique<std::byte[]>(capacity), capacity });
+}
+
+std::size_t FrameArena::GetCapacity() const {
+    std::size_t capacity = 0;
+    for (const auto& block : blocks)
+        capacity += block.size;
+    return capacity;
+}
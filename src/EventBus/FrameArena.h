@@ -0,0 +1,33 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for short lived data, e.g. the events of a frame. Nothing is freed one by
+// one, `Reset` drops everything at once and keeps the memory for the next frame.
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t blockSize = 64 * 1024);
+
+    // The memory stays valid until the next Reset, only trivially destructible data fits in
+    void* Allocate(std::size_t size, std::size_t alignment);
+
+    // A frame that needed several blocks gets a single block big enough for all of them
+    void Reset();
+
+    std::size_t GetCapacity() const;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::size_t blockSize;
+    std::vector<Block> blocks;
+    std::size_t used = 0;  // bytes of the last block
+};
+
+#endif  // FRAMEARENA_H
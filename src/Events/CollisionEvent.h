@@ -0,0 +1,12 @@
+#ifndef COLLISIONEVENT_H
+#define COLLISIONEVENT_H
+
+#include "ECS/ECS.h"
+
+// Two overlapping colliders, `a` is the entity with the lower index in the CollisionSystem
+struct CollisionEvent {
+    Entity a;
+    Entity b;
+};
+
+#endif  // COLLISIONEVENT_H
@@ -0,0 +1,16 @@
+#ifndef KEYPRESSEDEVENT_H
+#define KEYPRESSEDEVENT_H
+
+#include <SDL.h>
+
+struct KeyPressedEvent {
+    SDL_Keycode symbol;
+    Uint16 modifiers;  // `KMOD_*` flags held with the key
+
+    KeyPressedEvent(SDL_Keycode symbol = SDLK_UNKNOWN, Uint16 modifiers = KMOD_NONE) {
+        this->symbol = symbol;
+        this->modifiers = modifiers;
+    }
+};
+
+#endif  // KEYPRESSEDEVENT_H
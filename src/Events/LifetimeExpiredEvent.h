@@ -0,0 +1,12 @@
+#ifndef LIFETIMEEXPIREDEVENT_H
+#define LIFETIMEEXPIREDEVENT_H
+
+#include "ECS/ECS.h"
+
+// The LifetimeComponent of `entity` ran out, the LifetimeSystem kills it or its EntityPool
+// releases it
+struct LifetimeExpiredEvent {
+    Entity entity;
+};
+
+#endif  // LIFETIMEEXPIREDEVENT_H
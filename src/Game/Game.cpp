@@ -8,21 +8,55 @@
 // TODO: Create one header file for systems
 #include "AssetStore/AssetStore.h"
 #include "Components/AnimationComponent.h"
+#include "Components/BoxColliderComponent.h"
+#include "Components/ParentComponent.h"
+#include "Components/PathComponent.h"
 #include "ECS/ECS.h"
+#include "ECS/EntityPool.h"
+#include "ECS/Prefab.h"
+#include "ECS/RollbackBuffer.h"
+#include "EventBus/EventBus.h"
+#include "Game/GameWorld.h"
+#include "Events/KeyPressedEvent.h"
+#include "Jobs/WorkerPool.h"
+#include "Particles/ParticleSystem.h"
+#include "Prefabs/PrefabLoader.h"
+#include "Systems/AnimationSystem.h"
+#include "Systems/CollisionSystem.h"
+#include "Systems/HierarchySystem.h"
+#include "Systems/LifetimeSystem.h"
 #include "Systems/MovementSystem.h"
+#include "Systems/PathfindingSystem.h"
 #include "Systems/RenderSystem.h"
+#include "Systems/SpatialIndexSystem.h"
+#include "Timers/TimerService.h"
 
 #include <SDL.h>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <glm/glm.hpp>
 #include <string>
 
+namespace {
+    // The ring of bullets fired by the tank
+    constexpr int BULLET_COUNT = 16;
+    constexpr float BULLET_SPEED = 100.0f;
+}  // namespace
+
 Game::Game() {
     isRunning = false;
 
     // Create unique pointers
+    workers = std::make_unique<WorkerPool>();
+    eventBus = std::make_unique<EventBus>();
+    timers = std::make_unique<TimerService>();
     registry = std::make_unique<Registry>();
+    rollback = std::make_unique<RollbackBuffer>(ROLLBACK_FRAMES);
+    world = std::make_unique<GameWorld>(*registry);
     assetStore = std::make_unique<AssetStore>();
+    assetStore->SetTextureBudget(TEXTURE_BUDGET);
+    particles = std::make_unique<ParticleSystem>(assetStore);
 
     spdlog::info("Game constructor called.");
 }
@@ -81,6 +115,7 @@ void Game::ProcessInput() {
             case SDL_KEYDOWN:
                 if (sdlEvent.key.keysym.sym == SDLK_ESCAPE)
                     isRunning = false;
+                eventBus->Publish(KeyPressedEvent(sdlEvent.key.keysym.sym, sdlEvent.key.keysym.mod));
                 break;
         }
     }
@@ -88,13 +123,30 @@ void Game::ProcessInput() {
 
 void Game::LoadLevel(int level) {
     // Add the systems that need to be processed
-    registry->AddSystem<MovementSystem>();
-    registry->AddSystem<RenderSystem>();
+    world->AddSystem<PathfindingSystem>();
+    world->AddSystem<MovementSystem>();
+    world->AddSystem<HierarchySystem>();
+    world->AddSystem<CollisionSystem>();
+    world->AddSystem<SpatialIndexSystem>();
+    world->AddSystem<AnimationSystem>();
+    world->AddSystem<RenderSystem>(assetStore);
+    world->AddSystem<LifetimeSystem>(timers, eventBus);
+    world->GetSystem<PathfindingSystem>().SetMovementSystem(&world->GetSystem<MovementSystem>());
+    world->GetSystem<MovementSystem>().SubscribeToEvents(*eventBus);
+    world->GetSystem<CollisionSystem>().SetWorkerPool(workers.get());
+    world->GetSystem<HierarchySystem>().SetWorkerPool(workers.get());
+    world->GetSystem<RenderSystem>().SetParticleSystem(particles.get());
+
+    // Far from the screen, bodies move and animations advance every few frames
+    world->GetSystem<MovementSystem>().GetUpdateRate().SetEnabled(true);
+    world->GetSystem<AnimationSystem>().GetUpdateRate().SetEnabled(true);
 
     // Adding assets to the asset store
     assetStore->LoadTexture(renderer, "tank-image", "assets/images/tank-panther-right.png");
     assetStore->LoadTexture(renderer, "truck-image", "assets/images/truck-ford-down.png");
-    assetStore->LoadTmxFile(renderer, "village", "assets/tilemaps/village/map-village.tmx");
+    assetStore->LoadTexture(renderer, "bullet-image", "assets/images/bullet.png");
+    assetStore->LoadTmxFile(renderer, "village", "assets/tilemaps/village/map-village.tmx",
+                            { "vase", "house", "statue" });
     assetStore->LoadAseprite(renderer, "hero", "assets/images/characters/bento/anim.json");
     // 2. todo make assetstore to get data from assets.json
 
@@ -103,6 +155,14 @@ void Game::LoadLevel(int level) {
     tmxGround.AddComponent<SpriteComponent>("village", 0, 0, LAYER_TILEMAP, 0, 0, SpriteType::TILED);
     tmxGround.GetComponent<SpriteComponent>().tileLayerIndexes = {0, 1};
 
+    // The map is drawn at the ground transform, the units collide with it there
+    if (auto* collisionGrid = assetStore->GetCollisionGrid("village")) {
+        const auto& transform = tmxGround.ReadComponent<TransformComponent>();
+        collisionGrid->SetWorldTransform(transform.position, transform.scale);
+        world->GetSystem<MovementSystem>().SetCollisionGrid(collisionGrid);
+        world->GetSystem<PathfindingSystem>().SetCollisionGrid(collisionGrid);
+    }
+
     Entity tmxMisc = registry->CreateEntity();
     tmxMisc.AddComponent<TransformComponent>(glm::vec2(0, 0), glm::vec2(2.0f, 2.0f));
     tmxMisc.AddComponent<SpriteComponent>("village", 0, 0, LAYER_TILEMAP, 0, 0, SpriteType::TILED);
@@ -110,19 +170,49 @@ void Game::LoadLevel(int level) {
 
     // Create entities
     Entity tank = registry->CreateEntity();
+    tankId = tank.GetId();
     tank.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
     tank.AddComponent<RigidBodyComponent>(glm::vec2(40.0, 0.0));
     tank.AddComponent<SpriteComponent>("tank-image", 32, 32, LAYER_PLAYER);
+    tank.AddComponent<BoxColliderComponent>(32, 32);
 
     Entity hero = registry->CreateEntity();
-    tank.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
-    tank.AddComponent<RigidBodyComponent>(glm::vec2(40.0, 0.0));
-    tank.AddComponent<SpriteComponent>("hero", 32, 32, LAYER_PLAYER);
+    hero.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
+    hero.AddComponent<ParentComponent>(tank.GetId(), glm::vec2(0.0, -32.0));
+    hero.AddComponent<SpriteComponent>("hero", 32, 32, LAYER_PLAYER);
+    const AsepriteHandle heroAnimation = assetStore->GetAsepriteHandle("hero");
+    if (const auto* aseprite = assetStore->GetAsepriteObject(heroAnimation))
+        hero.AddComponent<AnimationComponent>(heroAnimation, std::max(aseprite->GetTagIndex("idle"), 0));
+
+    // The tank fires a ring of bullets now and on every space key, the bullets go back to
+    // their pool with their LifetimeComponent
+    Prefab bullet;
+    if (PrefabLoader::Load("assets/prefabs/bullet.json", bullet)) {
+        bullets = std::make_unique<EntityPool>(*registry, std::move(bullet), BULLET_COUNT, eventBus.get());
+        FireBullets();
+    }
+
+    // A fountain of sparks in the village
+    ParticleEmitterSettings sparks;
+    sparks.assetId = "bullet-image";
+    sparks.layer = LAYER_OBSTACLES;
+    sparks.capacity = 4096;
+    sparks.rate = 1000.0f;
+    sparks.lifetime = 2.0f;
+    sparks.lifetimeVariance = 0.5f;
+    sparks.velocity = glm::vec2(0.0f, -150.0f);
+    sparks.velocityVariance = glm::vec2(60.0f, 40.0f);
+    sparks.acceleration = glm::vec2(0.0f, 150.0f);
+    sparks.startColor = { 255, 220, 120, 255 };
+    sparks.endColor = { 255, 60, 0, 0 };
+    particles->AddEmitter(sparks, glm::vec2(400.0f, 300.0f));
 
     Entity truck = registry->CreateEntity();
     truck.AddComponent<TransformComponent>(glm::vec2(50.0, 100.0), glm::vec2(1.0, 1.0), 0.0);
-    truck.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 50.0));
+    truck.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
     truck.AddComponent<SpriteComponent>("truck-image", 32, 32, LAYER_ENEMIES);
+    truck.AddComponent<BoxColliderComponent>(32, 32);
+    truck.AddComponent<PathComponent>(glm::vec2(700.0, 500.0), 50.0f);
 
     // Entity hero = registry->CreateEntity();
     // hero.AddComponent<TransformComponent>(glm::vec2(0, 0), glm::vec2(0.2, 0.2), 0.0);
@@ -145,8 +235,41 @@ void Game::LoadLevel(int level) {
     tmxFrog.GetComponent<SpriteComponent>().tileLayerIndexes = {6};
 }
 
+void Game::FireBullets() {
+    if (!bullets || tankId < 0)
+        return;
+
+    const Entity tank(tankId);
+    const glm::vec2 center = registry->ReadComponent<TransformComponent>(tank).position + glm::vec2(16.0f, 16.0f);
+    for (int i = 0; i < BULLET_COUNT; i++) {
+        const float angle = 2.0f * static_cast<float>(M_PI) * i / BULLET_COUNT;
+        const glm::vec2 direction(std::cos(angle), std::sin(angle));
+        Entity bullet = bullets->Acquire();
+        bullet.GetComponent<TransformComponent>().position = center + direction * 16.0f;
+        bullet.GetComponent<RigidBodyComponent>().velocity = direction * BULLET_SPEED;
+    }
+}
+
 void Game::Setup() {
+    if (ASSET_HOT_RELOAD)
+        assetStore->EnableHotReload();
+
     LoadLevel(1);
+
+    // F5 saves the world in memory, F9 goes back to the saved world, backspace rewinds the
+    // last second, space fires
+    eventBus->Subscribe<KeyPressedEvent>([this](EventBatch<KeyPressedEvent> events) {
+        for (const auto& event : events) {
+            if (event.symbol == SDLK_F5)
+                quickSaveRequested = true;
+            else if (event.symbol == SDLK_F9)
+                quickLoadRequested = true;
+            else if (event.symbol == SDLK_BACKSPACE)
+                rewindRequested = true;
+            else if (event.symbol == SDLK_SPACE)
+                FireBullets();
+        }
+    });
 }
 
 void Game::Update() {
@@ -161,11 +284,50 @@ void Game::Update() {
     // Store the current frame time
     msPrevFrame = SDL_GetTicks();
 
-    // Invoke all the systems that we need to update
-    registry->GetSystem<MovementSystem>().Update(deltaTime);
+    // Swap the assets reloaded in the background
+    assetStore->Update();
+
+    // Invoke all the systems that we need to update, in the order of the GameWorld pipeline
+    UpdateFrame frame = { deltaTime, { 0, 0, windowWidth, windowHeight }, *registry, assetStore,
+                          *eventBus, *timers, *particles };
+    world->Tick(frame);
 
-    // Update the registry to process the entities that are waiting to be created/deleted
-    registry->Update();
+    // After the registry update, no entity is waiting for the next one
+    if (quickSaveRequested) {
+        registry->SaveSnapshot(quickSave);
+        quickSaveTime = timers->GetTime();
+        spdlog::info("Quick-saved, {} bytes", quickSave.size());
+    }
+    if (quickLoadRequested && !quickSave.empty()) {
+        // The lifetimes of the snapshot expire on its own clock
+        const double time = timers->GetTime();
+        timers->SetTime(quickSaveTime);
+        if (registry->LoadSnapshot(quickSave)) {
+            // The bullets dormant in the snapshot are the free ones
+            if (bullets)
+                bullets->Reclaim();
+            spdlog::info("Quick-loaded");
+        } else {
+            timers->SetTime(time);
+        }
+    }
+    quickSaveRequested = false;
+    quickLoadRequested = false;
+
+    // Back to the oldest frame kept, the game goes on from there. Any other frame is saved, only
+    // what changed since the previous one is copied.
+    if (rewindRequested && rollback->GetFrameCount() > 1) {
+        const std::uint32_t oldest = rollback->GetLatestFrame() - (rollback->GetFrameCount() - 1);
+        if (rollback->Restore(*registry, *timers, oldest)) {
+            if (bullets)
+                bullets->Reclaim();
+            frameNumber = oldest + 1;
+            spdlog::info("Rewound to frame {}", oldest);
+        }
+    } else {
+        rollback->Save(*registry, *timers, frameNumber++);
+    }
+    rewindRequested = false;
 }
 
 void Game::Render() {
@@ -173,7 +335,8 @@ void Game::Render() {
     SDL_RenderClear(renderer);
 
     // Invoke all the systems that we need to update
-    registry->GetSystem<RenderSystem>().Update(renderer, assetStore);
+    RenderFrame frame = { renderer, assetStore };
+    world->Tick(frame);
 
     SDL_RenderPresent(renderer);
 }
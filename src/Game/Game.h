@@ -2,24 +2,65 @@
 #define GAME_H
 
 #include <SDL.h>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 // Forward declaration
 class AssetStore;
+class EntityPool;
+class EventBus;
+class GameWorld;
+class ParticleSystem;
 class Registry;
+class RollbackBuffer;
+class TimerService;
+class WorkerPool;
 
 constexpr int FPS = 60;
 constexpr int MS_PER_FRAME = 1000 / FPS;
+constexpr std::size_t TEXTURE_BUDGET = 256 * 1024 * 1024;  // bytes
+constexpr std::size_t ROLLBACK_FRAMES = FPS;  // how far back the rewind goes
+
+// Reload the changed asset files while the game is running
+#ifdef NDEBUG
+constexpr bool ASSET_HOT_RELOAD = false;
+#else
+constexpr bool ASSET_HOT_RELOAD = true;
+#endif
 
 class Game {
 private:
     bool isRunning;
     int msPrevFrame = MS_PER_FRAME;
+    int tankId = -1;  // fires the bullets
+
+    // Registry snapshot of the last quick-save
+    std::vector<std::uint8_t> quickSave;
+    double quickSaveTime = 0.0;  // TimerService clock of the quick-save
+    bool quickSaveRequested = false;
+    bool quickLoadRequested = false;
+
+    // Number of the next frame saved in the rollback buffer
+    std::uint32_t frameNumber = 0;
+    bool rewindRequested = false;
     SDL_Window* window;
     SDL_Renderer* renderer;
 
+    // Declared first, the systems using them are destroyed before them
+    std::unique_ptr<WorkerPool> workers;  // shared by the systems with parallel loops
+    std::unique_ptr<EventBus> eventBus;
+    std::unique_ptr<TimerService> timers;
     std::unique_ptr<Registry> registry;
+    std::unique_ptr<EntityPool> bullets;  // back in the pool when their lifetime runs out
+    std::unique_ptr<RollbackBuffer> rollback;  // the last frames of the registry
+    std::unique_ptr<GameWorld> world;  // the systems of the registry, in update order
     std::unique_ptr<AssetStore> assetStore;
+    std::unique_ptr<ParticleSystem> particles;  // uses the asset store
+
+    // A ring of bullets around the tank
+    void FireBullets();
 
 public:
     // API - Application programming interface - START ---------------------------------------
@@ -0,0 +1,108 @@
+#ifndef GAMEWORLD_H
+#define GAMEWORLD_H
+
+#include "ECS/World.h"
+#include "EventBus/EventBus.h"
+#include "Particles/ParticleSystem.h"
+#include "Systems/AnimationSystem.h"
+#include "Systems/CollisionSystem.h"
+#include "Systems/HierarchySystem.h"
+#include "Systems/LifetimeSystem.h"
+#include "Systems/MovementSystem.h"
+#include "Systems/PathfindingSystem.h"
+#include "Systems/RenderSystem.h"
+#include "Systems/SpatialIndexSystem.h"
+#include "Timers/TimerService.h"
+
+#include <SDL.h>
+#include <memory>
+#include <type_traits>
+
+// Forward declaration
+class AssetStore;
+
+// What the stages need for one update of the game
+struct UpdateFrame {
+    double deltaTime;
+    SDL_Rect viewport;
+    Registry& registry;
+    const std::unique_ptr<AssetStore>& assetStore;
+    EventBus& eventBus;
+    TimerService& timers;
+    ParticleSystem& particles;
+};
+
+// What the stages need to draw a frame
+struct RenderFrame {
+    SDL_Renderer* renderer;
+    const std::unique_ptr<AssetStore>& assetStore;
+};
+
+// Stages that aren't systems
+struct DeliverEvents {};  // the input, collision and timer events of the frame
+struct UpdateParticles {};
+struct UpdateEntities {};  // creates/kills the entities waiting for the next update
+
+inline void TickStage(PathfindingSystem& system, UpdateFrame& frame) {
+    system.Update();
+}
+
+inline void TickStage(MovementSystem& system, UpdateFrame& frame) {
+    // Far from the screen, bodies move every few frames
+    system.GetUpdateRate().SetView(frame.viewport);
+    system.Update(frame.deltaTime, frame.registry);
+}
+
+inline void TickStage(HierarchySystem& system, UpdateFrame& frame) {
+    system.Update();
+}
+
+inline void TickStage(CollisionSystem& system, UpdateFrame& frame) {
+    system.Update(frame.eventBus);
+}
+
+inline void TickStage(DeliverEvents& stage, UpdateFrame& frame) {
+    frame.timers.Update(frame.deltaTime, frame.eventBus);
+    frame.eventBus.Dispatch();
+}
+
+inline void TickStage(SpatialIndexSystem& system, UpdateFrame& frame) {
+    system.Update(frame.registry);
+}
+
+inline void TickStage(AnimationSystem& system, UpdateFrame& frame) {
+    system.Update(frame.deltaTime, frame.assetStore, frame.viewport);
+}
+
+inline void TickStage(UpdateParticles& stage, UpdateFrame& frame) {
+    frame.particles.Update(frame.deltaTime);
+}
+
+inline void TickStage(UpdateEntities& stage, UpdateFrame& frame) {
+    frame.registry.Update();
+}
+
+inline void TickStage(RenderSystem& system, RenderFrame& frame) {
+    system.Update(frame.renderer, frame.assetStore);
+}
+
+// Only the render system draws, and it draws nothing in the update pass. The LifetimeSystem
+// only reacts to events.
+template <typename TStage>
+struct SkipsTick<TStage, RenderFrame> : std::negation<std::is_same<TStage, RenderSystem>> {};
+
+template <>
+struct SkipsTick<RenderSystem, UpdateFrame> : std::true_type {};
+
+template <>
+struct SkipsTick<LifetimeSystem, UpdateFrame> : std::true_type {};
+
+// The pipeline of the game, in update order
+class GameWorld : public World<PathfindingSystem, MovementSystem, HierarchySystem, CollisionSystem,
+                               DeliverEvents, SpatialIndexSystem, AnimationSystem, UpdateParticles,
+                               LifetimeSystem, UpdateEntities, RenderSystem> {
+public:
+    using World::World;
+};
+
+#endif  // GAMEWORLD_H
@@ -0,0 +1,71 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(unsigned int workerCount) {
+    for (unsigned int i = 0; i < workerCount; i++)
+        workers.emplace_back(&WorkerPool::WorkerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+unsigned int WorkerPool::DefaultWorkerCount() {
+    const unsigned int threads = std::thread::hardware_concurrency();
+    return threads > 1 ? threads - 1 : 0;
+}
+
+void WorkerPool::Run(InvokeFunction invoke, const void* job, std::size_t count, unsigned int chunks) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->invoke = invoke;
+        this->job = job;
+        this->count = count;
+        chunkSize = (count + chunks - 1) / chunks;
+        chunkCount = chunks;
+        nextChunk = 0;
+        finishedChunks = 0;
+        generation++;
+    }
+    wake.notify_all();
+
+    RunChunks();
+
+    // A worker still taking chunks would take them from the next loop, wait for all of them
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return finishedChunks == chunkCount && busyWorkers == 0; });
+}
+
+void WorkerPool::RunChunks() {
+    unsigned int chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < chunkCount) {
+        const std::size_t begin = std::min(count, chunk * chunkSize);
+        invoke(job, chunk, begin, std::min(count, begin + chunkSize));
+        finishedChunks.fetch_add(1);
+    }
+}
+
+void WorkerPool::WorkerLoop() {
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+            busyWorkers++;
+        }
+
+        RunChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0)
+            done.notify_one();
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads started once and shared by the systems for their data parallel loops, so a frame
+// doesn't pay for creating and joining threads. One loop runs at a time, started from the
+// main thread, the calling thread works on it too.
+class WorkerPool {
+public:
+    // `workerCount` threads besides the calling one
+    explicit WorkerPool(unsigned int workerCount = DefaultWorkerCount());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // The calling thread included
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(workers.size()) + 1; }
+
+    // Splits [0, count) in `chunks` equal ranges and runs `job(chunk, begin, end)` on each,
+    // returns when all of them are done. The split only depends on the arguments, not on
+    // which thread takes a chunk.
+    template <typename TJob>
+    void ParallelFor(std::size_t count, unsigned int chunks, const TJob& job);
+
+    static unsigned int DefaultWorkerCount();
+
+private:
+    using InvokeFunction = void (*)(const void* job, unsigned int chunk, std::size_t begin, std::size_t end);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::uint64_t generation = 0;
+    unsigned int busyWorkers = 0;
+    bool stopping = false;
+
+    // The loop in progress, written under the lock before `generation` changes
+    InvokeFunction invoke = nullptr;
+    const void* job = nullptr;
+    std::size_t count = 0;
+    std::size_t chunkSize = 0;
+    unsigned int chunkCount = 0;
+    std::atomic<unsigned int> nextChunk{ 0 };
+    std::atomic<unsigned int> finishedChunks{ 0 };
+
+    void Run(InvokeFunction invoke, const void* job, std::size_t count, unsigned int chunks);
+    void RunChunks();
+    void WorkerLoop();
+
+    template <typename TJob>
+    static void Invoke(const void* job, unsigned int chunk, std::size_t begin, std::size_t end) {
+        (*static_cast<const TJob*>(job))(chunk, begin, end);
+    }
+};
+
+template <typename TJob>
+void WorkerPool::ParallelFor(std::size_t count, unsigned int chunks, const TJob& job) {
+    chunks = std::max(1u, chunks);
+    if (chunks > 1 && !workers.empty()) {
+        Run(&Invoke<TJob>, &job, count, chunks);
+        return;
+    }
+
+    const std::size_t size = (count + chunks - 1) / chunks;
+    for (unsigned int chunk = 0; chunk < chunks; chunk++) {
+        const std::size_t begin = std::min(count, chunk * size);
+        job(chunk, begin, std::min(count, begin + size));
+    }
+}
+
+#endif  // WORKERPOOL_H
@@ -0,0 +1,142 @@
+#include "ParticleEmitter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE2
+#endif
+
+namespace {
+    constexpr std::size_t SIMD_WIDTH = 4;
+
+    std::size_t PadToSimdWidth(std::size_t count) {
+        return (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    }
+
+    Uint8 Lerp(Uint8 start, Uint8 end, float t) {
+        return static_cast<Uint8>(end + (start - end) * t + 0.5f);
+    }
+}  // namespace
+
+ParticleEmitter::ParticleEmitter(const ParticleEmitterSettings& settings, glm::vec2 position)
+    : settings(settings), position(position), random(std::random_device()()) {
+    // Allocated once, the padding lets the kernels run past the last particle
+    const std::size_t capacity = PadToSimdWidth(settings.capacity);
+    positionX.resize(capacity);
+    positionY.resize(capacity);
+    velocityX.resize(capacity);
+    velocityY.resize(capacity);
+    life.resize(capacity);
+    inverseLifetime.resize(capacity);
+
+    for (std::size_t i = 0; i < colorRamp.size(); i++) {
+        const float t = static_cast<float>(i) / (colorRamp.size() - 1);
+        const SDL_Color& start = settings.startColor;
+        const SDL_Color& end = settings.endColor;
+        colorRamp[i] = { Lerp(start.r, end.r, t), Lerp(start.g, end.g, t), Lerp(start.b, end.b, t),
+                         Lerp(start.a, end.a, t) };
+    }
+}
+
+void ParticleEmitter::Emit(std::size_t emitCount) {
+    const std::size_t end = std::min(settings.capacity, count + emitCount);
+    for (std::size_t i = count; i < end; i++) {
+        const float lifetime =
+            std::max(settings.lifetime + Variance(settings.lifetimeVariance), 0.001f);
+        positionX[i] = position.x;
+        positionY[i] = position.y;
+        velocityX[i] = settings.velocity.x + Variance(settings.velocityVariance.x);
+        velocityY[i] = settings.velocity.y + Variance(settings.velocityVariance.y);
+        life[i] = lifetime;
+        inverseLifetime[i] = 1.0f / lifetime;
+    }
+    count = std::max(count, end);
+}
+
+void ParticleEmitter::Update(float deltaTime) {
+    Integrate(deltaTime);
+    RemoveDead();
+
+    if (!emitting || settings.rate <= 0.0f)
+        return;
+    spawnAccumulator += settings.rate * deltaTime;
+    const float spawned = std::floor(spawnAccumulator);
+    spawnAccumulator -= spawned;
+    Emit(static_cast<std::size_t>(spawned));
+}
+
+void ParticleEmitter::Integrate(float deltaTime) {
+    const float accelerationX = settings.acceleration.x * deltaTime;
+    const float accelerationY = settings.acceleration.y * deltaTime;
+    const std::size_t end = PadToSimdWidth(count);
+
+#ifdef PARTICLES_SSE2
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 ax = _mm_set1_ps(accelerationX);
+    const __m128 ay = _mm_set1_ps(accelerationY);
+    for (std::size_t i = 0; i < end; i += SIMD_WIDTH) {
+        const __m128 vx = _mm_add_ps(_mm_loadu_ps(&velocityX[i]), ax);
+        const __m128 vy = _mm_add_ps(_mm_loadu_ps(&velocityY[i]), ay);
+        _mm_storeu_ps(&velocityX[i], vx);
+        _mm_storeu_ps(&velocityY[i], vy);
+        _mm_storeu_ps(&positionX[i], _mm_add_ps(_mm_loadu_ps(&positionX[i]), _mm_mul_ps(vx, dt)));
+        _mm_storeu_ps(&positionY[i], _mm_add_ps(_mm_loadu_ps(&positionY[i]), _mm_mul_ps(vy, dt)));
+        _mm_storeu_ps(&life[i], _mm_sub_ps(_mm_loadu_ps(&life[i]), dt));
+    }
+#else
+    for (std::size_t i = 0; i < end; i++) {
+        velocityX[i] += accelerationX;
+        velocityY[i] += accelerationY;
+        positionX[i] += velocityX[i] * deltaTime;
+        positionY[i] += velocityY[i] * deltaTime;
+        life[i] -= deltaTime;
+    }
+#endif
+}
+
+void ParticleEmitter::RemoveDead() {
+    // The last particle takes the place of the dead one, the order doesn't matter
+    std::size_t i = 0;
+    while (i < count) {
+        if (life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        count--;
+        positionX[i] = positionX[count];
+        positionY[i] = positionY[count];
+        velocityX[i] = velocityX[count];
+        velocityY[i] = velocityY[count];
+        life[i] = life[count];
+        inverseLifetime[i] = inverseLifetime[count];
+    }
+}
+
+void ParticleEmitter::WriteVertices(SDL_Vertex* vertices, const SDL_FRect& uv) const {
+    const float half = settings.size * 0.5f;
+    const float maxRamp = static_cast<float>(colorRamp.size() - 1);
+
+    for (std::size_t i = 0; i < count; i++) {
+        // Life left is 1 when spawned, 0 when dead
+        const float t = std::min(life[i] * inverseLifetime[i], 1.0f);
+        const SDL_Color color = colorRamp[static_cast<int>(t * maxRamp)];
+        const float left = positionX[i] - half;
+        const float top = positionY[i] - half;
+        const float right = positionX[i] + half;
+        const float bottom = positionY[i] + half;
+
+        SDL_Vertex* quad = vertices + i * 4;
+        quad[0] = { { left, top }, color, { uv.x, uv.y } };
+        quad[1] = { { right, top }, color, { uv.x + uv.w, uv.y } };
+        quad[2] = { { right, bottom }, color, { uv.x + uv.w, uv.y + uv.h } };
+        quad[3] = { { left, bottom }, color, { uv.x, uv.y + uv.h } };
+    }
+}
+
+float ParticleEmitter::Variance(float variance) {
+    if (variance == 0.0f)
+        return 0.0f;
+    return std::uniform_real_distribution<float>(-variance, variance)(random);
+}
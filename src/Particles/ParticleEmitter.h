@@ -0,0 +1,80 @@
+#ifndef PARTICLEEMITTER_H
+#define PARTICLEEMITTER_H
+
+#include "Components/SpriteComponent.h"
+
+#include <SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+struct ParticleEmitterSettings {
+    std::string assetId;
+    SDL_Rect srcRect = { 0, 0, 0, 0 };  // the whole texture when empty
+    RenderLayers layer = LAYER_VEGETATION;
+    std::size_t capacity = 1024;  // live particles, the others are not spawned
+    float rate = 0.0f;  // particles per second, 0 for `Emit` bursts only
+    float lifetime = 1.0f;  // seconds
+    float lifetimeVariance = 0.0f;
+    glm::vec2 velocity = glm::vec2(0.0f);
+    glm::vec2 velocityVariance = glm::vec2(0.0f);
+    glm::vec2 acceleration = glm::vec2(0.0f);  // e.g. gravity
+    float size = 4.0f;  // pixels
+    SDL_Color startColor = { 255, 255, 255, 255 };
+    SDL_Color endColor = { 255, 255, 255, 0 };
+};
+
+// Particles are not entities, an emitter keeps them in one array per attribute and updates
+// them 4 at a time. Dead particles are replaced by the last one, so the live particles stay
+// packed at the front. The color goes from the start to the end color over the lifetime.
+class ParticleEmitter {
+    ParticleEmitterSettings settings;
+    glm::vec2 position;
+    bool emitting = true;
+    float spawnAccumulator = 0.0f;
+    std::minstd_rand random;
+
+    // [ index = life left * 255 / lifetime ] colors over the lifetime
+    std::array<SDL_Color, 256> colorRamp;
+
+    // [ index = particle ] padded to a multiple of 4
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> life;  // seconds left
+    std::vector<float> inverseLifetime;
+    std::size_t count = 0;
+
+public:
+    explicit ParticleEmitter(const ParticleEmitterSettings& settings,
+                             glm::vec2 position = glm::vec2(0.0f));
+
+    void SetPosition(glm::vec2 position) { this->position = position; }
+    glm::vec2 GetPosition() const { return position; }
+
+    // Stops the continuous spawning, the live particles run out
+    void SetEmitting(bool emitting) { this->emitting = emitting; }
+
+    // Spawns up to `count` particles at once
+    void Emit(std::size_t count);
+
+    void Update(float deltaTime);
+
+    // Writes 4 vertices per live particle, `uv` is the source rectangle in texture coordinates
+    void WriteVertices(SDL_Vertex* vertices, const SDL_FRect& uv) const;
+
+    std::size_t GetCount() const { return count; }
+    const ParticleEmitterSettings& GetSettings() const { return settings; }
+
+private:
+    void Integrate(float deltaTime);
+    void RemoveDead();
+    float Variance(float variance);
+};
+
+#endif  // PARTICLEEMITTER_H
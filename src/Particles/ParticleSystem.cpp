@@ -0,0 +1,110 @@
+#include "ParticleSystem.h"
+
+#include "AssetStore/AssetStore.h"
+
+#include <algorithm>
+
+ParticleSystem::ParticleSystem(const std::unique_ptr<AssetStore>& assetStore)
+    : assetStore(assetStore.get()) {}
+
+ParticleSystem::~ParticleSystem() {
+    for (const auto& emitter : emitters)
+        assetStore->ReleaseAsset(emitter->GetSettings().assetId);
+}
+
+ParticleEmitter& ParticleSystem::AddEmitter(const ParticleEmitterSettings& settings,
+                                            glm::vec2 position) {
+    assetStore->RetainAsset(settings.assetId);
+
+    // After the emitters of the same layer and texture
+    const auto sortsBefore = [](const ParticleEmitterSettings& settings,
+                                const std::unique_ptr<ParticleEmitter>& emitter) {
+        const auto& other = emitter->GetSettings();
+        return settings.layer < other.layer ||
+               (settings.layer == other.layer && settings.assetId < other.assetId);
+    };
+    const auto next = std::upper_bound(emitters.begin(), emitters.end(), settings, sortsBefore);
+    return **emitters.insert(next, std::make_unique<ParticleEmitter>(settings, position));
+}
+
+void ParticleSystem::RemoveEmitter(const ParticleEmitter& emitter) {
+    const auto isEmitter = [&emitter](const auto& other) { return other.get() == &emitter; };
+    const auto found = std::find_if(emitters.begin(), emitters.end(), isEmitter);
+    if (found == emitters.end())
+        return;
+
+    assetStore->ReleaseAsset(emitter.GetSettings().assetId);
+    emitters.erase(found);
+}
+
+void ParticleSystem::Update(double deltaTime) {
+    for (auto& emitter : emitters)
+        emitter->Update(static_cast<float>(deltaTime));
+}
+
+void ParticleSystem::Render(SDL_Renderer* renderer, RenderLayers layer) {
+    // Runs of emitters with the same texture
+    std::size_t begin = 0;
+    while (begin < emitters.size() && emitters[begin]->GetSettings().layer < layer)
+        begin++;
+    while (begin < emitters.size() && emitters[begin]->GetSettings().layer == layer) {
+        const auto& assetId = emitters[begin]->GetSettings().assetId;
+        std::size_t end = begin;
+        std::size_t particleCount = 0;
+        while (end < emitters.size() && emitters[end]->GetSettings().layer == layer &&
+               emitters[end]->GetSettings().assetId == assetId) {
+            particleCount += emitters[end]->GetCount();
+            end++;
+        }
+
+        if (particleCount > 0)
+            Draw(renderer, begin, end, particleCount);
+        begin = end;
+    }
+}
+
+std::size_t ParticleSystem::GetParticleCount() const {
+    std::size_t count = 0;
+    for (const auto& emitter : emitters)
+        count += emitter->GetCount();
+    return count;
+}
+
+void ParticleSystem::Draw(SDL_Renderer* renderer, std::size_t begin, std::size_t end,
+                          std::size_t particleCount) {
+    SDL_Texture* texture = assetStore->GetTexture(emitters[begin]->GetSettings().assetId);
+    int textureWidth = 0;
+    int textureHeight = 0;
+    if (!texture || SDL_QueryTexture(texture, nullptr, nullptr, &textureWidth, &textureHeight) != 0)
+        return;
+    if (textureWidth == 0 || textureHeight == 0)
+        return;
+
+    if (vertices.size() < particleCount * 4)
+        vertices.resize(particleCount * 4);
+
+    // Two triangles per quad, the pattern never changes
+    const std::size_t indexCount = particleCount * 6;
+    for (std::size_t quad = indices.size() / 6; quad < particleCount; quad++) {
+        const int first = static_cast<int>(quad * 4);
+        indices.insert(indices.end(), { first, first + 1, first + 2, first + 2, first + 3, first });
+    }
+
+    SDL_Vertex* output = vertices.data();
+    for (std::size_t i = begin; i < end; i++) {
+        const auto& emitter = *emitters[i];
+        SDL_Rect srcRect = emitter.GetSettings().srcRect;
+        if (srcRect.w == 0 || srcRect.h == 0)
+            srcRect = { 0, 0, textureWidth, textureHeight };
+        const SDL_FRect uv = { static_cast<float>(srcRect.x) / textureWidth,
+                               static_cast<float>(srcRect.y) / textureHeight,
+                               static_cast<float>(srcRect.w) / textureWidth,
+                               static_cast<float>(srcRect.h) / textureHeight };
+
+        emitter.WriteVertices(output, uv);
+        output += emitter.GetCount() * 4;
+    }
+
+    SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(particleCount * 4),
+                       indices.data(), static_cast<int>(indexCount));
+}
@@ -0,0 +1,46 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include "ParticleEmitter.h"
+
+#include <SDL.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Forward declaration
+class AssetStore;
+
+// Owns the particle emitters, outside of the ECS. The RenderSystem draws the particles of a
+// layer after its sprites, the emitters sharing a texture in one `SDL_RenderGeometry` call.
+class ParticleSystem {
+    AssetStore* assetStore;  // keeps the textures of the emitters alive
+    std::vector<std::unique_ptr<ParticleEmitter>> emitters;  // sorted by layer then texture
+
+    // Reused by every draw call, they only grow
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+
+public:
+    explicit ParticleSystem(const std::unique_ptr<AssetStore>& assetStore);
+    ~ParticleSystem();
+
+    ParticleSystem(const ParticleSystem&) = delete;
+    ParticleSystem& operator=(const ParticleSystem&) = delete;
+
+    // The emitter lives until removed or until the system is destroyed
+    ParticleEmitter& AddEmitter(const ParticleEmitterSettings& settings,
+                                glm::vec2 position = glm::vec2(0.0f));
+    void RemoveEmitter(const ParticleEmitter& emitter);
+
+    void Update(double deltaTime);
+    void Render(SDL_Renderer* renderer, RenderLayers layer);
+
+    std::size_t GetParticleCount() const;
+
+private:
+    void Draw(SDL_Renderer* renderer, std::size_t begin, std::size_t end,
+              std::size_t particleCount);
+};
+
+#endif  // PARTICLESYSTEM_H
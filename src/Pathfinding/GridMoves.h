@@ -0,0 +1,54 @@
+#ifndef GRIDMOVES_H
+#define GRIDMOVES_H
+
+#include "AssetStore/Tiled/CollisionGrid.h"
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Tiles from the start to the goal, both included. Empty when the goal can't be reached.
+using GridPath = std::vector<glm::ivec2>;
+
+// Movement rules shared by all the searches: 8 directions, no cutting of wall corners
+namespace pathfinding {
+    // Move costs, a diagonal is about sqrt(2) straight moves
+    constexpr std::uint32_t STRAIGHT_COST = 10;
+    constexpr std::uint32_t DIAGONAL_COST = 14;
+    constexpr std::uint32_t UNREACHED = std::numeric_limits<std::uint32_t>::max();
+
+    // The first 4 are the straight ones
+    constexpr int DIRECTION_COUNT = 8;
+    inline const glm::ivec2 DIRECTIONS[DIRECTION_COUNT] = {
+        { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { 1, -1 }, { -1, -1 },
+    };
+
+    inline std::uint32_t MoveCost(int direction) {
+        return direction < 4 ? STRAIGHT_COST : DIAGONAL_COST;
+    }
+
+    // A diagonal move needs both straight neighbours free, so units don't cut wall corners
+    inline bool CanMove(const tiled::CollisionGrid& grid, int column, int row, glm::ivec2 direction) {
+        if (grid.IsSolid(column + direction.x, row + direction.y))
+            return false;
+        if (direction.x != 0 && direction.y != 0)
+            return !grid.IsSolid(column + direction.x, row) && !grid.IsSolid(column, row + direction.y);
+        return true;
+    }
+
+    // Octile distance, exact on an empty grid
+    inline std::uint32_t Heuristic(glm::ivec2 from, glm::ivec2 to) {
+        const std::uint32_t dx = std::abs(from.x - to.x);
+        const std::uint32_t dy = std::abs(from.y - to.y);
+        return STRAIGHT_COST * std::max(dx, dy) + (DIAGONAL_COST - STRAIGHT_COST) * std::min(dx, dy);
+    }
+
+    inline bool IsInside(const tiled::CollisionGrid& grid, glm::ivec2 cell) {
+        return cell.x >= 0 && cell.y >= 0 && cell.x < grid.GetWidth() && cell.y < grid.GetHeight();
+    }
+}  // namespace pathfinding
+
+#endif  // GRIDMOVES_H
@@ -0,0 +1,477 @@
+#include "HierarchicalGraph.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <utility>
+
+using namespace pathfinding;
+
+namespace {
+    // A border opening shorter than this gets one entrance in its middle, a longer one
+    // gets one at each end so units don't detour through the middle of wide openings
+    constexpr int SPLIT_ENTRANCE_LENGTH = 6;
+
+    // The entrance search overestimates the remaining cost by 10%. The paths get slightly
+    // longer, but the search stops exploring the wide band of almost equally good entrances.
+    constexpr std::uint32_t HEURISTIC_WEIGHT_PERCENT = 110;
+
+    // Abstract nodes are (cluster << 32 | entrance), the start and goal tiles get their own keys
+    constexpr std::uint64_t START_NODE = ~std::uint64_t(0);
+    constexpr std::uint64_t GOAL_NODE = ~std::uint64_t(0) - 1;
+
+    std::uint64_t NodeKey(int cluster, int entrance) {
+        return (static_cast<std::uint64_t>(cluster) << 32) | static_cast<std::uint32_t>(entrance);
+    }
+
+    bool CellLess(glm::ivec2 a, glm::ivec2 b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    }
+
+    // Below this many clusters starting threads costs more than it saves
+    constexpr std::size_t PARALLEL_MIN_CLUSTERS = 64;
+
+    // Dijkstra limited to the tiles of one area, reused by every search of a thread
+    struct AreaSearch {
+        glm::ivec2 min;
+        int width = 0;
+        std::vector<std::uint8_t> moves;  // [ tile ] bit per allowed direction, the moves stay inside
+        std::vector<std::uint32_t> cost;
+        std::vector<int> parent;
+
+        // Bucket queue: the move costs are small, so the open tiles are kept in one bucket per
+        // cost modulo a size larger than the biggest move, no heap needed
+        static constexpr std::uint32_t BUCKET_COUNT = 16;
+        std::vector<int> buckets[BUCKET_COUNT];
+
+        int Local(glm::ivec2 cell) const { return (cell.y - min.y) * width + cell.x - min.x; }
+        glm::ivec2 Cell(int local) const { return min + glm::ivec2(local % width, local / width); }
+
+        // The moves are checked once per area instead of once per search
+        void SetArea(const tiled::CollisionGrid& grid, glm::ivec2 areaMin, glm::ivec2 areaMax) {
+            min = areaMin;
+            width = areaMax.x - areaMin.x + 1;
+            moves.assign(width * (areaMax.y - areaMin.y + 1), 0);
+            for (int y = areaMin.y; y <= areaMax.y; y++) {
+                for (int x = areaMin.x; x <= areaMax.x; x++) {
+                    std::uint8_t& tileMoves = moves[Local(glm::ivec2(x, y))];
+                    for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                        const glm::ivec2 next = glm::ivec2(x, y) + DIRECTIONS[direction];
+                        if (next.x >= areaMin.x && next.y >= areaMin.y && next.x <= areaMax.x && next.y <= areaMax.y
+                            && CanMove(grid, x, y, DIRECTIONS[direction]))
+                            tileMoves |= 1 << direction;
+                    }
+                }
+            }
+        }
+
+        // Stops once `target` is settled, without one the whole area is settled
+        void Run(glm::ivec2 source, const glm::ivec2* target = nullptr) {
+            cost.assign(moves.size(), UNREACHED);
+            parent.assign(moves.size(), -1);
+            for (auto& bucket : buckets)
+                bucket.clear();
+
+            const int targetIndex = target ? Local(*target) : -1;
+            cost[Local(source)] = 0;
+            buckets[0].push_back(Local(source));
+            std::size_t open = 1;
+            for (std::uint32_t current = 0; open > 0; current++) {
+                auto& bucket = buckets[current % BUCKET_COUNT];
+                while (!bucket.empty()) {
+                    const int index = bucket.back();
+                    bucket.pop_back();
+                    open--;
+                    if (cost[index] != current)
+                        continue;
+                    if (index == targetIndex)
+                        return;
+
+                    const std::uint8_t tileMoves = moves[index];
+                    for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+                        if (!((tileMoves >> direction) & 1))
+                            continue;
+
+                        const int nextIndex = index + DIRECTIONS[direction].y * width + DIRECTIONS[direction].x;
+                        const std::uint32_t nextCost = current + MoveCost(direction);
+                        if (nextCost >= cost[nextIndex])
+                            continue;
+                        cost[nextIndex] = nextCost;
+                        parent[nextIndex] = index;
+                        buckets[nextCost % BUCKET_COUNT].push_back(nextIndex);
+                        open++;
+                    }
+                }
+            }
+        }
+
+        // Appends the tiles after the source up to `target`, false when it wasn't reached
+        bool AppendPath(glm::ivec2 target, GridPath& path) const {
+            int index = Local(target);
+            if (cost[index] == UNREACHED)
+                return false;
+
+            const std::size_t first = path.size();
+            for (; parent[index] != -1; index = parent[index])
+                path.push_back(Cell(index));
+            std::reverse(path.begin() + first, path.end());
+            return true;
+        }
+    };
+}  // namespace
+
+int HierarchicalGraph::Cluster::GetEntrance(glm::ivec2 cell) const {
+    auto entrance = std::lower_bound(entrances.begin(), entrances.end(), cell, CellLess);
+    if (entrance == entrances.end() || *entrance != cell)
+        return -1;
+    return static_cast<int>(entrance - entrances.begin());
+}
+
+HierarchicalGraph::HierarchicalGraph()
+    : clusterSize(16)
+    , columns(0)
+    , rows(0)
+    , gridWidth(0)
+    , gridHeight(0)
+    , entranceCount(0) {
+}
+
+void HierarchicalGraph::Build(const tiled::CollisionGrid& grid, int size) {
+    clusterSize = std::max(2, size);
+    gridWidth = grid.GetWidth();
+    gridHeight = grid.GetHeight();
+    columns = (gridWidth + clusterSize - 1) / clusterSize;
+    rows = (gridHeight + clusterSize - 1) / clusterSize;
+
+    clusters.assign(static_cast<std::size_t>(columns) * rows, nullptr);
+    std::vector<int> indexes(clusters.size());
+    for (std::size_t i = 0; i < indexes.size(); i++)
+        indexes[i] = static_cast<int>(i);
+    BuildClusters(grid, indexes);
+
+    spdlog::info("Path graph built: {}x{} clusters, {} entrances", columns, rows, GetEntranceCount());
+}
+
+void HierarchicalGraph::Update(const tiled::CollisionGrid& previousGrid, const tiled::CollisionGrid& grid) {
+    if (!IsBuilt(grid) || previousGrid.GetWidth() != gridWidth || previousGrid.GetHeight() != gridHeight) {
+        Build(grid, clusterSize);
+        return;
+    }
+
+    // A changed tile changes its cluster, and the neighbour across when it lies on a border
+    std::vector<bool> dirty(clusters.size(), false);
+    const auto markDirty = [&](int column, int row) {
+        const int clusterColumn = column / clusterSize;
+        const int clusterRow = row / clusterSize;
+        dirty[clusterRow * columns + clusterColumn] = true;
+        if (column % clusterSize == 0 && clusterColumn > 0)
+            dirty[clusterRow * columns + clusterColumn - 1] = true;
+        if (column % clusterSize == clusterSize - 1 && clusterColumn < columns - 1)
+            dirty[clusterRow * columns + clusterColumn + 1] = true;
+        if (row % clusterSize == 0 && clusterRow > 0)
+            dirty[(clusterRow - 1) * columns + clusterColumn] = true;
+        if (row % clusterSize == clusterSize - 1 && clusterRow < rows - 1)
+            dirty[(clusterRow + 1) * columns + clusterColumn] = true;
+    };
+
+    for (int row = 0; row < gridHeight; row++) {
+        const std::uint64_t* before = previousGrid.GetRowWords(row);
+        const std::uint64_t* after = grid.GetRowWords(row);
+        for (int word = 0; word < grid.GetWordsPerRow(); word++) {
+            const std::uint64_t changed = before[word] ^ after[word];
+            if (changed == 0)
+                continue;
+            for (int bit = 0; bit < 64; bit++) {
+                if ((changed >> bit) & 1)
+                    markDirty(word * 64 + bit, row);
+            }
+        }
+    }
+
+    std::vector<int> indexes;
+    for (std::size_t i = 0; i < dirty.size(); i++) {
+        if (dirty[i])
+            indexes.push_back(static_cast<int>(i));
+    }
+    if (!indexes.empty())
+        BuildClusters(grid, indexes);
+}
+
+void HierarchicalGraph::BuildClusters(const tiled::CollisionGrid& grid, const std::vector<int>& indexes) {
+    const auto build = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++)
+            clusters[indexes[i]] = BuildCluster(grid, indexes[i]);
+    };
+
+    // The clusters don't depend on each other, every thread builds an equal share
+    const unsigned int threads = indexes.size() >= PARALLEL_MIN_CLUSTERS
+                                     ? std::max(1u, std::thread::hardware_concurrency())
+                                     : 1;
+    const std::size_t chunk = (indexes.size() + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    for (unsigned int thread = 1; thread < threads; thread++) {
+        const std::size_t begin = std::min(indexes.size(), thread * chunk);
+        workers.emplace_back(build, begin, std::min(indexes.size(), begin + chunk));
+    }
+    build(0, std::min(indexes.size(), chunk));
+    for (auto& worker : workers)
+        worker.join();
+
+    UpdateOffsets();
+}
+
+void HierarchicalGraph::UpdateOffsets() {
+    entranceOffsets.resize(clusters.size());
+    entranceCount = 0;
+    for (std::size_t i = 0; i < clusters.size(); i++) {
+        entranceOffsets[i] = entranceCount;
+        entranceCount += static_cast<int>(clusters[i]->entrances.size());
+    }
+}
+
+std::shared_ptr<const HierarchicalGraph::Cluster> HierarchicalGraph::BuildCluster(const tiled::CollisionGrid& grid,
+                                                                                  int index) const {
+    const int column = index % columns;
+    const int row = index / columns;
+    auto cluster = std::make_shared<Cluster>();
+    cluster->min = glm::ivec2(column * clusterSize, row * clusterSize);
+    cluster->max = glm::ivec2(std::min(cluster->min.x + clusterSize, gridWidth) - 1,
+                              std::min(cluster->min.y + clusterSize, gridHeight) - 1);
+
+    // Runs of tiles free on both sides of a border. Both clusters of a border scan the same
+    // tiles in the same order, so they agree on the entrances.
+    auto& entrances = cluster->entrances;
+    const auto addBorder = [&](glm::ivec2 first, glm::ivec2 step, int count, glm::ivec2 outside) {
+        int runStart = -1;
+        for (int i = 0; i <= count; i++) {
+            const glm::ivec2 cell = first + step * i;
+            const bool free = i < count && !grid.IsSolid(cell.x, cell.y)
+                              && !grid.IsSolid(cell.x + outside.x, cell.y + outside.y);
+            if (free) {
+                if (runStart < 0)
+                    runStart = i;
+                continue;
+            }
+            if (runStart < 0)
+                continue;
+
+            const int runEnd = i - 1;
+            if (runEnd - runStart + 1 < SPLIT_ENTRANCE_LENGTH) {
+                entrances.push_back(first + step * ((runStart + runEnd) / 2));
+            } else {
+                entrances.push_back(first + step * runStart);
+                entrances.push_back(first + step * runEnd);
+            }
+            runStart = -1;
+        }
+    };
+
+    const glm::ivec2 size = cluster->max - cluster->min + 1;
+    if (column > 0)
+        addBorder(cluster->min, glm::ivec2(0, 1), size.y, glm::ivec2(-1, 0));
+    if (column < columns - 1)
+        addBorder(glm::ivec2(cluster->max.x, cluster->min.y), glm::ivec2(0, 1), size.y, glm::ivec2(1, 0));
+    if (row > 0)
+        addBorder(cluster->min, glm::ivec2(1, 0), size.x, glm::ivec2(0, -1));
+    if (row < rows - 1)
+        addBorder(glm::ivec2(cluster->min.x, cluster->max.y), glm::ivec2(1, 0), size.x, glm::ivec2(0, 1));
+
+    // Corner tiles can be entrances of two borders
+    std::sort(entrances.begin(), entrances.end(), CellLess);
+    entrances.erase(std::unique(entrances.begin(), entrances.end()), entrances.end());
+
+    // Path costs between every two entrances without leaving the cluster
+    thread_local AreaSearch search;
+    search.SetArea(grid, cluster->min, cluster->max);
+    const std::size_t count = entrances.size();
+    cluster->costs.resize(count * count);
+    for (std::size_t from = 0; from < count; from++) {
+        search.Run(entrances[from]);
+        for (std::size_t to = 0; to < count; to++)
+            cluster->costs[from * count + to] = search.cost[search.Local(entrances[to])];
+    }
+    return cluster;
+}
+
+int HierarchicalGraph::ClusterOf(glm::ivec2 cell) const {
+    return (cell.y / clusterSize) * columns + cell.x / clusterSize;
+}
+
+GridPath HierarchicalGraph::FindPath(const tiled::CollisionGrid& grid, glm::ivec2 start, glm::ivec2 goal) const {
+    GridPath path;
+    if (!IsBuilt(grid) || !IsInside(grid, start) || !IsInside(grid, goal) || grid.IsSolid(goal.x, goal.y))
+        return path;
+
+    thread_local AreaSearch search;
+    thread_local std::vector<std::uint32_t> startCosts;
+    thread_local std::vector<std::uint32_t> goalCosts;
+
+    // Connect the start and the goal to the entrances of their clusters
+    const int startCluster = ClusterOf(start);
+    const int goalCluster = ClusterOf(goal);
+    const Cluster& first = *clusters[startCluster];
+    const Cluster& last = *clusters[goalCluster];
+
+    search.SetArea(grid, first.min, first.max);
+    search.Run(start);
+    startCosts.resize(first.entrances.size());
+    for (std::size_t i = 0; i < first.entrances.size(); i++)
+        startCosts[i] = search.cost[search.Local(first.entrances[i])];
+    const std::uint32_t directCost = startCluster == goalCluster ? search.cost[search.Local(goal)] : UNREACHED;
+
+    // The moves are symmetric, the costs from the goal are the costs to it
+    search.SetArea(grid, last.min, last.max);
+    search.Run(goal);
+    goalCosts.resize(last.entrances.size());
+    for (std::size_t i = 0; i < last.entrances.size(); i++)
+        goalCosts[i] = search.cost[search.Local(last.entrances[i])];
+
+    const auto cellOf = [&](std::uint64_t node) {
+        if (node == START_NODE)
+            return start;
+        if (node == GOAL_NODE)
+            return goal;
+        return clusters[node >> 32]->entrances[node & 0xffffffffu];
+    };
+
+    // A* over the entrances. The node state lives in flat arrays indexed by
+    // entrance offset, a slot belongs to this search when its stamp matches.
+    // Open entries sort by estimate, then by the larger cost so far, so ties go deeper first
+    using OpenEntry = std::pair<std::uint64_t, std::uint64_t>;  // (total << 32 | ~cost), node
+    const auto makeEntry = [](std::uint32_t total, std::uint32_t cost, std::uint64_t node) {
+        return OpenEntry((static_cast<std::uint64_t>(total) << 32) | static_cast<std::uint32_t>(~cost), node);
+    };
+    thread_local std::vector<std::uint32_t> nodeCost;
+    thread_local std::vector<std::uint64_t> nodeParent;
+    thread_local std::vector<std::uint32_t> nodeStamp;
+    thread_local std::uint32_t generation = 0;
+    thread_local std::vector<OpenEntry> open;
+
+    const std::size_t slots = static_cast<std::size_t>(entranceCount) + 2;
+    if (nodeStamp.size() < slots) {
+        nodeCost.resize(slots);
+        nodeParent.resize(slots);
+        nodeStamp.resize(slots, 0);
+    }
+    if (++generation == 0) {
+        std::fill(nodeStamp.begin(), nodeStamp.end(), 0);
+        generation = 1;
+    }
+    open.clear();
+
+    const auto slotOf = [&](std::uint64_t node) -> std::size_t {
+        if (node == START_NODE)
+            return entranceCount;
+        if (node == GOAL_NODE)
+            return entranceCount + 1;
+        return entranceOffsets[node >> 32] + (node & 0xffffffffu);
+    };
+
+    const auto estimate = [&](std::uint64_t node) {
+        return Heuristic(cellOf(node), goal) * HEURISTIC_WEIGHT_PERCENT / 100;
+    };
+
+    const auto greater = std::greater<OpenEntry>();
+    const auto relax = [&](std::uint64_t from, std::uint32_t fromCost, std::uint64_t to, std::uint32_t edgeCost) {
+        const std::uint32_t cost = fromCost + edgeCost;
+        const std::size_t slot = slotOf(to);
+        if (nodeStamp[slot] == generation && nodeCost[slot] <= cost)
+            return;
+        nodeStamp[slot] = generation;
+        nodeCost[slot] = cost;
+        nodeParent[slot] = from;
+        open.push_back(makeEntry(cost + estimate(to), cost, to));
+        std::push_heap(open.begin(), open.end(), greater);
+    };
+
+    nodeStamp[slotOf(START_NODE)] = generation;
+    nodeCost[slotOf(START_NODE)] = 0;
+    open.push_back(makeEntry(estimate(START_NODE), 0, START_NODE));
+    bool found = false;
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), greater);
+        const auto [order, node] = open.back();
+        open.pop_back();
+
+        // Skip the stale entries of nodes reached again with a lower cost
+        const std::uint32_t cost = nodeCost[slotOf(node)];
+        if (static_cast<std::uint32_t>(~order) != cost)
+            continue;
+        if (node == GOAL_NODE) {
+            found = true;
+            break;
+        }
+
+        if (node == START_NODE) {
+            for (std::size_t i = 0; i < startCosts.size(); i++) {
+                if (startCosts[i] != UNREACHED)
+                    relax(node, cost, NodeKey(startCluster, static_cast<int>(i)), startCosts[i]);
+            }
+            if (directCost != UNREACHED)
+                relax(node, cost, GOAL_NODE, directCost);
+            continue;
+        }
+
+        const int clusterIndex = static_cast<int>(node >> 32);
+        const int entrance = static_cast<int>(node & 0xffffffffu);
+        const Cluster& cluster = *clusters[clusterIndex];
+        const std::size_t count = cluster.entrances.size();
+
+        for (std::size_t other = 0; other < count; other++) {
+            const std::uint32_t edgeCost = cluster.costs[entrance * count + other];
+            if (static_cast<int>(other) != entrance && edgeCost != UNREACHED)
+                relax(node, cost, NodeKey(clusterIndex, static_cast<int>(other)), edgeCost);
+        }
+        if (clusterIndex == goalCluster && goalCosts[entrance] != UNREACHED)
+            relax(node, cost, GOAL_NODE, goalCosts[entrance]);
+
+        // Step across the border into the entrance of the neighbour cluster
+        const glm::ivec2 cell = cluster.entrances[entrance];
+        for (int direction = 0; direction < 4; direction++) {
+            const glm::ivec2 next = cell + DIRECTIONS[direction];
+            if (!IsInside(grid, next) || grid.IsSolid(next.x, next.y))
+                continue;
+            const int nextCluster = ClusterOf(next);
+            if (nextCluster == clusterIndex)
+                continue;
+            const int nextEntrance = clusters[nextCluster]->GetEntrance(next);
+            if (nextEntrance >= 0)
+                relax(node, cost, NodeKey(nextCluster, nextEntrance), STRAIGHT_COST);
+        }
+    }
+    if (!found)
+        return path;
+
+    std::vector<std::uint64_t> route;
+    for (std::uint64_t node = GOAL_NODE; node != START_NODE; node = nodeParent[slotOf(node)])
+        route.push_back(node);
+    route.push_back(START_NODE);
+    std::reverse(route.begin(), route.end());
+
+    // Refine: tile searches inside one cluster at a time, border steps are single moves
+    int areaCluster = goalCluster;
+    path.push_back(start);
+    for (std::size_t i = 1; i < route.size(); i++) {
+        const std::uint64_t from = route[i - 1];
+        const std::uint64_t to = route[i];
+        const int fromCluster = from == START_NODE ? startCluster : static_cast<int>(from >> 32);
+        const int toCluster = to == GOAL_NODE ? goalCluster : static_cast<int>(to >> 32);
+
+        if (fromCluster != toCluster) {
+            path.push_back(cellOf(to));
+            continue;
+        }
+
+        if (areaCluster != fromCluster) {
+            search.SetArea(grid, clusters[fromCluster]->min, clusters[fromCluster]->max);
+            areaCluster = fromCluster;
+        }
+        const glm::ivec2 target = cellOf(to);
+        search.Run(cellOf(from), &target);
+        if (!search.AppendPath(target, path))
+            return GridPath();
+    }
+    return path;
+}
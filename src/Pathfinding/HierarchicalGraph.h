@@ -0,0 +1,66 @@
+#ifndef HIERARCHICALGRAPH_H
+#define HIERARCHICALGRAPH_H
+
+#include "AssetStore/Tiled/CollisionGrid.h"
+#include "GridMoves.h"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// HPA* abstraction of a CollisionGrid. The grid is cut in square clusters, the free tiles
+// along each cluster border become entrances, and the shortest path cost between every
+// two entrances of a cluster is precomputed. A long search then walks entrances, and only
+// the clusters on the route are searched tile by tile to build the final path.
+//
+// Clusters are shared between copies of the graph, so a copy with a few clusters rebuilt
+// is cheap and the searches running on the old copy are not disturbed.
+class HierarchicalGraph {
+public:
+    struct Cluster {
+        glm::ivec2 min;  // first tile
+        glm::ivec2 max;  // last tile, included
+        std::vector<glm::ivec2> entrances;  // sorted by row, then column
+        std::vector<std::uint32_t> costs;  // [ from * entrances + to ] UNREACHED without a path inside
+
+        int GetEntrance(glm::ivec2 cell) const;
+    };
+
+    HierarchicalGraph();
+
+    void Build(const tiled::CollisionGrid& grid, int clusterSize);
+
+    // Rebuilds only the clusters around the tiles that differ between the grids
+    void Update(const tiled::CollisionGrid& previousGrid, const tiled::CollisionGrid& grid);
+
+    // Path over the entrances refined to tiles, a few percent longer than the shortest path
+    GridPath FindPath(const tiled::CollisionGrid& grid, glm::ivec2 start, glm::ivec2 goal) const;
+
+    int GetClusterSize() const { return clusterSize; }
+    std::size_t GetEntranceCount() const { return entranceCount; }
+    bool IsBuilt(const tiled::CollisionGrid& grid) const {
+        return !clusters.empty() && grid.GetWidth() == gridWidth && grid.GetHeight() == gridHeight;
+    }
+
+private:
+    int clusterSize;
+    int columns;
+    int rows;
+    int gridWidth;
+    int gridHeight;
+    std::vector<std::shared_ptr<const Cluster>> clusters;  // [ row * columns + column ]
+
+    // Searches keep their node state in flat arrays, the entrances of a cluster start at its offset
+    std::vector<int> entranceOffsets;  // [ cluster ]
+    int entranceCount;
+
+    // Builds the clusters of the list on all the cores
+    void BuildClusters(const tiled::CollisionGrid& grid, const std::vector<int>& indexes);
+    std::shared_ptr<const Cluster> BuildCluster(const tiled::CollisionGrid& grid, int index) const;
+    void UpdateOffsets();
+    int ClusterOf(glm::ivec2 cell) const;
+};
+
+#endif  // HIERARCHICALGRAPH_H
@@ -0,0 +1,317 @@
+#include "Pathfinder.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+using namespace pathfinding;
+
+namespace {
+    // A full cache is dropped, the paths of the current goals come back quickly
+    constexpr std::size_t MAX_CACHED_PATHS = 4096;
+    constexpr std::size_t MAX_CACHED_FLOW_FIELDS = 64;
+
+    // Paths spanning fewer clusters than this are cheaper to search tile by tile
+    constexpr int HIERARCHICAL_MIN_CLUSTERS = 2;
+
+    // Flow field keys can't collide with path keys, the tile indexes use 31 bits
+    constexpr std::uint64_t FLOW_FIELD_KEY = std::uint64_t(1) << 63;
+
+    using OpenEntry = std::pair<std::uint32_t, int>;  // cost, tile index
+
+    // Per thread search buffers. A tile was reached by the current search when its stamp
+    // matches, so the buffers are never cleared between searches.
+    struct SearchScratch {
+        std::vector<std::uint32_t> cost;
+        std::vector<int> parent;
+        std::vector<std::uint32_t> stamp;
+        std::uint32_t generation = 0;
+        std::vector<OpenEntry> open;
+
+        void Begin(std::size_t tiles) {
+            if (cost.size() < tiles) {
+                cost.resize(tiles);
+                parent.resize(tiles);
+                stamp.resize(tiles, 0);
+            }
+            if (++generation == 0) {
+                std::fill(stamp.begin(), stamp.end(), 0);
+                generation = 1;
+            }
+            open.clear();
+        }
+
+        bool Reached(int index) const { return stamp[index] == generation; }
+    };
+}  // namespace
+
+Pathfinder::Pathfinder(unsigned int workerCount) {
+    for (unsigned int i = 0; i < std::max(1u, workerCount); i++)
+        workers.emplace_back(&Pathfinder::WorkerLoop, this);
+}
+
+Pathfinder::~Pathfinder() {
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobsReady.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+void Pathfinder::SetGrid(const tiled::CollisionGrid& collisionGrid) {
+    if (grid && collisionGrid.GetVersion() == gridVersion)
+        return;
+
+    // Only the clusters around the changed tiles are rebuilt, the rest is shared with the old graph
+    auto nextGraph = graph ? std::make_shared<HierarchicalGraph>(*graph) : std::make_shared<HierarchicalGraph>();
+    if (grid && nextGraph->IsBuilt(*grid) && nextGraph->GetClusterSize() == clusterSize)
+        nextGraph->Update(*grid, collisionGrid);
+    else
+        nextGraph->Build(collisionGrid, clusterSize);
+    graph = std::move(nextGraph);
+
+    // The searches in flight keep the old copies, their results come back with the old version
+    grid = std::make_shared<const tiled::CollisionGrid>(collisionGrid);
+    gridVersion = collisionGrid.GetVersion();
+    pathCache.clear();
+    flowFieldCache.clear();
+    pending.clear();
+}
+
+void Pathfinder::SetClusterSize(int size) {
+    clusterSize = std::max(2, size);
+    graph.reset();
+    grid.reset();
+}
+
+std::uint32_t Pathfinder::FindPath(glm::ivec2 start, glm::ivec2 goal) {
+    if (!grid || !IsInside(*grid, start) || !IsInside(*grid, goal)) {
+        const std::uint32_t id = nextId++;
+        ready.push_back({ id, gridVersion, std::make_shared<const GridPath>(), nullptr });
+        return id;
+    }
+
+    const std::uint64_t key = (static_cast<std::uint64_t>(start.y * grid->GetWidth() + start.x) << 32)
+                              | static_cast<std::uint32_t>(goal.y * grid->GetWidth() + goal.x);
+    auto cached = pathCache.find(key);
+    if (cached != pathCache.end()) {
+        const std::uint32_t id = nextId++;
+        ready.push_back({ id, gridVersion, cached->second, nullptr });
+        return id;
+    }
+    return Queue(key, false, start, goal);
+}
+
+std::uint32_t Pathfinder::FindFlowField(glm::ivec2 goal) {
+    if (!grid || !IsInside(*grid, goal)) {
+        const std::uint32_t id = nextId++;
+        ready.push_back({ id, gridVersion, nullptr, std::make_shared<const FlowField>() });
+        return id;
+    }
+
+    const std::uint64_t key = FLOW_FIELD_KEY | static_cast<std::uint32_t>(goal.y * grid->GetWidth() + goal.x);
+    auto cached = flowFieldCache.find(key);
+    if (cached != flowFieldCache.end()) {
+        const std::uint32_t id = nextId++;
+        ready.push_back({ id, gridVersion, nullptr, cached->second });
+        return id;
+    }
+    return Queue(key, true, goal, goal);
+}
+
+std::uint32_t Pathfinder::Queue(std::uint64_t key, bool flowField, glm::ivec2 start, glm::ivec2 goal) {
+    // Many units asking for the same route share one search
+    auto inFlight = pending.find(key);
+    if (inFlight != pending.end())
+        return inFlight->second;
+
+    const std::uint32_t id = nextId++;
+    pending.emplace(key, id);
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.push_back({ id, key, flowField, start, goal, grid, graph, gridVersion, nullptr, nullptr });
+    }
+    jobsReady.notify_one();
+    return id;
+}
+
+std::size_t Pathfinder::TakeResults(std::vector<PathResult>& results, std::size_t budget) {
+    std::size_t taken = 0;
+    while (taken < budget && !ready.empty()) {
+        results.push_back(std::move(ready.back()));
+        ready.pop_back();
+        taken++;
+    }
+    if (taken == budget)
+        return taken;
+
+    std::deque<Job> done;
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        while (taken + done.size() < budget && !finished.empty()) {
+            done.push_back(std::move(finished.front()));
+            finished.pop_front();
+        }
+    }
+
+    for (auto& job : done) {
+        auto inFlight = pending.find(job.key);
+        if (inFlight != pending.end() && inFlight->second == job.id)
+            pending.erase(inFlight);
+
+        // Results built from an older grid are still handed out, but never cached
+        if (job.gridVersion == gridVersion) {
+            if (job.flowField) {
+                if (flowFieldCache.size() >= MAX_CACHED_FLOW_FIELDS)
+                    flowFieldCache.clear();
+                flowFieldCache[job.key] = job.field;
+            } else {
+                if (pathCache.size() >= MAX_CACHED_PATHS)
+                    pathCache.clear();
+                pathCache[job.key] = job.path;
+            }
+        }
+        results.push_back({ job.id, job.gridVersion, std::move(job.path), std::move(job.field) });
+        taken++;
+    }
+    return taken;
+}
+
+void Pathfinder::WorkerLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsReady.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        const glm::ivec2 distance = glm::abs(job.goal - job.start);
+        if (job.flowField)
+            job.field = std::make_shared<const FlowField>(BuildFlowField(*job.grid, job.goal));
+        else if (std::max(distance.x, distance.y) >= HIERARCHICAL_MIN_CLUSTERS * job.graph->GetClusterSize())
+            job.path = std::make_shared<const GridPath>(job.graph->FindPath(*job.grid, job.start, job.goal));
+        else
+            job.path = std::make_shared<const GridPath>(SearchPath(*job.grid, job.start, job.goal));
+        job.grid.reset();
+        job.graph.reset();
+
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finished.push_back(std::move(job));
+    }
+}
+
+GridPath Pathfinder::SearchPath(const tiled::CollisionGrid& grid, glm::ivec2 start, glm::ivec2 goal) {
+    GridPath path;
+    if (!IsInside(grid, start) || !IsInside(grid, goal) || grid.IsSolid(goal.x, goal.y))
+        return path;
+
+    thread_local SearchScratch scratch;
+    const int width = grid.GetWidth();
+    scratch.Begin(static_cast<std::size_t>(width) * grid.GetHeight());
+
+    // The start tile may be solid, a unit pushed into a wall can still walk out
+    const int startIndex = start.y * width + start.x;
+    const int goalIndex = goal.y * width + goal.x;
+    scratch.cost[startIndex] = 0;
+    scratch.parent[startIndex] = -1;
+    scratch.stamp[startIndex] = scratch.generation;
+    scratch.open.push_back({ Heuristic(start, goal), startIndex });
+
+    const auto greater = std::greater<OpenEntry>();
+    while (!scratch.open.empty()) {
+        std::pop_heap(scratch.open.begin(), scratch.open.end(), greater);
+        const auto [estimate, index] = scratch.open.back();
+        scratch.open.pop_back();
+        if (index == goalIndex)
+            break;
+
+        const glm::ivec2 cell(index % width, index / width);
+        const std::uint32_t cost = scratch.cost[index];
+
+        // Skip the stale entries of tiles reached again with a lower cost
+        if (estimate != cost + Heuristic(cell, goal))
+            continue;
+
+        for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+            const glm::ivec2 offset = DIRECTIONS[direction];
+            if (!CanMove(grid, cell.x, cell.y, offset))
+                continue;
+
+            const glm::ivec2 next = cell + offset;
+            const int nextIndex = next.y * width + next.x;
+            const std::uint32_t nextCost = cost + MoveCost(direction);
+            if (scratch.Reached(nextIndex) && scratch.cost[nextIndex] <= nextCost)
+                continue;
+
+            scratch.cost[nextIndex] = nextCost;
+            scratch.parent[nextIndex] = index;
+            scratch.stamp[nextIndex] = scratch.generation;
+            scratch.open.push_back({ nextCost + Heuristic(next, goal), nextIndex });
+            std::push_heap(scratch.open.begin(), scratch.open.end(), greater);
+        }
+    }
+
+    if (!scratch.Reached(goalIndex))
+        return path;
+
+    for (int index = goalIndex; index != -1; index = scratch.parent[index])
+        path.emplace_back(index % width, index / width);
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+FlowField Pathfinder::BuildFlowField(const tiled::CollisionGrid& grid, glm::ivec2 goal) {
+    FlowField field;
+    field.width = grid.GetWidth();
+    field.height = grid.GetHeight();
+    field.goal = goal;
+    field.directions.assign(static_cast<std::size_t>(field.width) * field.height, FlowField::NONE);
+    if (!IsInside(grid, goal) || grid.IsSolid(goal.x, goal.y))
+        return field;
+
+    thread_local SearchScratch scratch;
+    const int width = field.width;
+    scratch.Begin(field.directions.size());
+
+    // Dijkstra from the goal, every tile points back at the tile it was reached from.
+    // The moves are symmetric, so following the directions walks a shortest path to the goal.
+    const int goalIndex = goal.y * width + goal.x;
+    scratch.cost[goalIndex] = 0;
+    scratch.stamp[goalIndex] = scratch.generation;
+    scratch.open.push_back({ 0, goalIndex });
+
+    const auto greater = std::greater<OpenEntry>();
+    while (!scratch.open.empty()) {
+        std::pop_heap(scratch.open.begin(), scratch.open.end(), greater);
+        const auto [cost, index] = scratch.open.back();
+        scratch.open.pop_back();
+        if (cost != scratch.cost[index])
+            continue;
+
+        const glm::ivec2 cell(index % width, index / width);
+        for (int direction = 0; direction < DIRECTION_COUNT; direction++) {
+            const glm::ivec2 offset = DIRECTIONS[direction];
+            if (!CanMove(grid, cell.x, cell.y, offset))
+                continue;
+
+            const int nextIndex = (cell.y + offset.y) * width + cell.x + offset.x;
+            const std::uint32_t nextCost = cost + MoveCost(direction);
+            if (scratch.Reached(nextIndex) && scratch.cost[nextIndex] <= nextCost)
+                continue;
+
+            scratch.cost[nextIndex] = nextCost;
+            scratch.stamp[nextIndex] = scratch.generation;
+            // The opposite direction, the table pairs them as (0, 1), (2, 3), (4, 7), (5, 6)
+            field.directions[nextIndex] = static_cast<std::uint8_t>(direction < 4 ? direction ^ 1 : 11 - direction);
+            scratch.open.push_back({ nextCost, nextIndex });
+            std::push_heap(scratch.open.begin(), scratch.open.end(), greater);
+        }
+    }
+    return field;
+}
@@ -0,0 +1,122 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include "AssetStore/Tiled/CollisionGrid.h"
+#include "GridMoves.h"
+#include "HierarchicalGraph.h"
+#include "glm/glm.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Direction to the next tile towards the goal for every tile of the grid, built once
+// and shared by all the units going to the same goal
+struct FlowField {
+    static constexpr std::uint8_t NONE = 255;
+
+    int width = 0;
+    int height = 0;
+    glm::ivec2 goal = glm::ivec2(0, 0);
+    std::vector<std::uint8_t> directions;  // [ row * width + column ] index in pathfinding::DIRECTIONS or NONE
+
+    // (0, 0) at the goal and on the tiles the goal can't be reached from
+    glm::ivec2 GetDirection(glm::ivec2 cell) const {
+        if (cell.x < 0 || cell.y < 0 || cell.x >= width || cell.y >= height)
+            return glm::ivec2(0, 0);
+        const std::uint8_t direction = directions[cell.y * width + cell.x];
+        return direction == NONE ? glm::ivec2(0, 0) : pathfinding::DIRECTIONS[direction];
+    }
+
+    bool CanReach(glm::ivec2 cell) const {
+        return cell == goal || GetDirection(cell) != glm::ivec2(0, 0);
+    }
+};
+
+struct PathResult {
+    std::uint32_t id;
+    std::uint32_t gridVersion;  // version of the grid the result was built from
+    std::shared_ptr<const GridPath> path;  // set for FindPath requests
+    std::shared_ptr<const FlowField> flowField;  // set for FindFlowField requests
+};
+
+// A* and flow fields over a CollisionGrid, moving in 8 directions without cutting corners.
+// The searches run on worker threads against an immutable copy of the grid, so the grid can
+// change while they run. Finished results are cached until the grid version changes, and
+// identical requests in flight share one search. Long paths are searched over a
+// HierarchicalGraph, which is updated cluster by cluster when tiles change.
+class Pathfinder {
+    struct Job {
+        std::uint32_t id;
+        std::uint64_t key;
+        bool flowField;
+        glm::ivec2 start;
+        glm::ivec2 goal;
+        std::shared_ptr<const tiled::CollisionGrid> grid;
+        std::shared_ptr<const HierarchicalGraph> graph;
+        std::uint32_t gridVersion;
+        std::shared_ptr<const GridPath> path;
+        std::shared_ptr<const FlowField> field;
+    };
+
+    std::shared_ptr<const tiled::CollisionGrid> grid;
+    std::shared_ptr<const HierarchicalGraph> graph;
+    std::uint32_t gridVersion = 0;
+    std::uint32_t nextId = 1;
+    int clusterSize = 16;
+
+    // Owned by the calling thread
+    std::unordered_map<std::uint64_t, std::shared_ptr<const GridPath>> pathCache;
+    std::unordered_map<std::uint64_t, std::shared_ptr<const FlowField>> flowFieldCache;
+    std::unordered_map<std::uint64_t, std::uint32_t> pending;  // request key -> id of the search in flight
+    std::vector<PathResult> ready;  // cache hits, handed out with the next results
+
+    // Shared with the workers
+    std::mutex jobsMutex;
+    std::condition_variable jobsReady;
+    std::deque<Job> jobs;
+    bool stopping = false;
+    std::mutex finishedMutex;
+    std::deque<Job> finished;
+
+    std::vector<std::thread> workers;
+
+public:
+    explicit Pathfinder(unsigned int workerCount = 1);
+    ~Pathfinder();
+
+    Pathfinder(const Pathfinder&) = delete;
+    Pathfinder& operator=(const Pathfinder&) = delete;
+
+    // Copies the grid when its version changed and drops the cached results, cheap otherwise
+    void SetGrid(const tiled::CollisionGrid& collisionGrid);
+    std::uint32_t GetGridVersion() const { return gridVersion; }
+
+    // Tiles per side of the hierarchical graph clusters, the graph is rebuilt with the next grid
+    void SetClusterSize(int size);
+
+    // Queue a search and return its id, the result comes out of TakeResults
+    std::uint32_t FindPath(glm::ivec2 start, glm::ivec2 goal);
+    std::uint32_t FindFlowField(glm::ivec2 goal);
+
+    // Appends at most `budget` finished results, the rest wait for the next call
+    std::size_t TakeResults(std::vector<PathResult>& results, std::size_t budget);
+
+    std::size_t GetPendingCount() const { return pending.size(); }
+
+    // Synchronous searches, run by the workers
+    static GridPath SearchPath(const tiled::CollisionGrid& grid, glm::ivec2 start, glm::ivec2 goal);
+    static FlowField BuildFlowField(const tiled::CollisionGrid& grid, glm::ivec2 goal);
+
+private:
+    std::uint32_t Queue(std::uint64_t key, bool flowField, glm::ivec2 start, glm::ivec2 goal);
+    void WorkerLoop();
+};
+
+#endif  // PATHFINDER_H
@@ -0,0 +1,108 @@
+#include "PrefabLoader.h"
+
+#include "Components/BoxColliderComponent.h"
+#include "Components/LifetimeComponent.h"
+#include "Components/PathComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/TransformComponent.h"
+#include "glm/glm.hpp"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <fstream>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace {
+    const std::unordered_map<std::string, RenderLayers> LAYER_NAMES = {
+        { "tilemap", LAYER_TILEMAP }, { "vegetation", LAYER_VEGETATION }, { "obstacles", LAYER_OBSTACLES },
+        { "enemies", LAYER_ENEMIES }, { "player", LAYER_PLAYER },         { "gui", LAYER_GUI },
+    };
+
+    glm::vec2 ReadVec2(const json& values, const char* key, glm::vec2 fallback) {
+        const auto value = values.find(key);
+        if (value == values.end() || !value->is_array() || value->size() != 2 || !(*value)[0].is_number()
+            || !(*value)[1].is_number())
+            return fallback;
+        return glm::vec2((*value)[0].get<float>(), (*value)[1].get<float>());
+    }
+
+    template <typename T>
+    T Read(const json& values, const char* key, T fallback) {
+        const auto value = values.find(key);
+        if (value == values.end() || value->is_null())
+            return fallback;
+        if constexpr (std::is_arithmetic<T>::value) {
+            if (!value->is_number())
+                return fallback;
+        } else if (!value->is_string()) {
+            return fallback;
+        }
+        return value->get<T>();
+    }
+
+    // Returns false for an unknown component name
+    bool AddComponent(Prefab& prefab, const std::string& name, const json& values) {
+        if (name == "TransformComponent") {
+            const TransformComponent defaults;
+            prefab.AddComponent<TransformComponent>(ReadVec2(values, "position", defaults.position),
+                                                    ReadVec2(values, "scale", defaults.scale),
+                                                    Read(values, "rotation", defaults.rotation));
+        } else if (name == "RigidBodyComponent") {
+            prefab.AddComponent<RigidBodyComponent>(ReadVec2(values, "velocity", glm::vec2(0)));
+        } else if (name == "SpriteComponent") {
+            RenderLayers layer = LAYER_TILEMAP;
+            const auto layerName = LAYER_NAMES.find(Read<std::string>(values, "layer", "tilemap"));
+            if (layerName != LAYER_NAMES.end())
+                layer = layerName->second;
+            const glm::vec2 srcRect = ReadVec2(values, "srcRect", glm::vec2(0));
+            prefab.AddComponent<SpriteComponent>(Read<std::string>(values, "assetId", ""),
+                                                 Read(values, "width", 0), Read(values, "height", 0), layer,
+                                                 static_cast<int>(srcRect.x), static_cast<int>(srcRect.y));
+        } else if (name == "BoxColliderComponent") {
+            prefab.AddComponent<BoxColliderComponent>(Read(values, "width", 0), Read(values, "height", 0),
+                                                      ReadVec2(values, "offset", glm::vec2(0)));
+        } else if (name == "LifetimeComponent") {
+            prefab.AddComponent<LifetimeComponent>(Read(values, "lifetime", 1.0));
+        } else if (name == "PathComponent") {
+            const PathComponent defaults;
+            prefab.AddComponent<PathComponent>(ReadVec2(values, "target", defaults.target),
+                                               Read(values, "speed", defaults.speed));
+        } else {
+            return false;
+        }
+        return true;
+    }
+}  // namespace
+
+bool PrefabLoader::Load(const std::string& filePath, Prefab& prefab) {
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        spdlog::error("Prefab file doesn't exist: {}", filePath);
+        return false;
+    }
+
+    const json document = json::parse(file, nullptr, false);
+    if (document.is_discarded() || !document.is_object()) {
+        spdlog::error("Failed to parse prefab json: {}", filePath);
+        return false;
+    }
+
+    const auto components = document.find("components");
+    if (components == document.end() || !components->is_object()) {
+        spdlog::error("Prefab has no components: {}", filePath);
+        return false;
+    }
+
+    for (const auto& component : components->items()) {
+        if (!component.value().is_object()) {
+            spdlog::warn("Prefab component {} is not an object: {}", component.key(), filePath);
+            continue;
+        }
+        if (!AddComponent(prefab, component.key(), component.value()))
+            spdlog::warn("Unknown prefab component {}: {}", component.key(), filePath);
+    }
+    return true;
+}
@@ -0,0 +1,16 @@
+#ifndef PREFABLOADER_H
+#define PREFABLOADER_H
+
+#include "ECS/Prefab.h"
+
+#include <string>
+
+// Reads a prefab from a JSON file:
+//   { "components": { "TransformComponent": { "scale": [2, 2] }, "LifetimeComponent": { "lifetime": 3 } } }
+// The values left out keep the component defaults, unknown components are skipped.
+class PrefabLoader {
+public:
+    static bool Load(const std::string& filePath, Prefab& prefab);
+};
+
+#endif  // PREFABLOADER_H
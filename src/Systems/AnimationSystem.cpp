@@ -1 +1,81 @@
 #include "AnimationSystem.h"
+
+#include "AssetStore/AssetStore.h"
+#include "Components/AnimationComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/TransformComponent.h"
+
+#include <cmath>
+
+AnimationSystem::AnimationSystem() {
+    RequireComponent<AnimationComponent>();
+    RequireComponent<SpriteComponent>();
+    RequireComponent<TransformComponent>();
+}
+
+void AnimationSystem::Update(double deltaTime, const std::unique_ptr<AssetStore>& assetStore,
+                             const SDL_Rect& viewport) {
+    updateRate.SetView(viewport);
+    updateRate.BeginFrame(deltaTime);
+
+    // Entities of the same kind are usually created together, so cache the last lookup
+    AsepriteHandle cachedHandle = INVALID_ASEPRITE_HANDLE;
+    const AsepriteObject* aseprite = nullptr;
+
+    for (auto entity : GetSystemEntities()) {
+        if (!entity.IsActive())
+            continue;
+
+        auto& animation = entity.GetComponent<AnimationComponent>();
+
+        // Paused animations cost a single branch, the time paused is not caught up
+        if (!animation.isPlaying) {
+            updateRate.Reset(entity);
+            continue;
+        }
+
+        // Far animations wait for their turn
+        const auto& transform = entity.ReadComponent<TransformComponent>();
+        double step;
+        if (!updateRate.Step(entity, transform.position, step))
+            continue;
+
+        if (animation.animationData != cachedHandle) {
+            cachedHandle = animation.animationData;
+            aseprite = assetStore->GetAsepriteObject(cachedHandle);
+        }
+        if (!aseprite || animation.tagIndex < 0
+            || animation.tagIndex >= static_cast<int>(aseprite->frameTags.size()))
+            continue;
+
+        // Advance the clock and keep it inside one animation cycle to avoid losing float precision
+        const auto& tag = aseprite->frameTags[animation.tagIndex];
+        const float cycle = static_cast<float>(
+            tag.direction == TagDirection::PINGPONG ? 2 * tag.duration : tag.duration);
+        animation.elapsedTime += static_cast<float>(step * 1000.0);
+        if (cycle > 0.0f && animation.elapsedTime >= cycle)
+            animation.elapsedTime = std::fmod(animation.elapsedTime, cycle);
+
+        // Skip off-screen entities
+        const auto& sprite = entity.ReadComponent<SpriteComponent>();
+        const float x = transform.position.x;
+        const float y = transform.position.y;
+        const float width = sprite.width * transform.scale.x;
+        const float height = sprite.height * transform.scale.y;
+        if (x + width < viewport.x || y + height < viewport.y || x > viewport.x + viewport.w
+            || y > viewport.y + viewport.h)
+            continue;
+
+        // Resolve the frame source rectangle only when the frame changes
+        const int frameIndex = aseprite->GetFrameIndex(animation.tagIndex,
+                                                       static_cast<int>(animation.elapsedTime));
+        if (frameIndex == animation.currentFrame)
+            continue;
+        animation.currentFrame = frameIndex;
+
+        // Only the sprites of a new frame count as changed
+        const auto& frame = aseprite->frames[frameIndex];
+        entity.GetComponent<SpriteComponent>().srcRect = { frame.x, frame.y, frame.width,
+                                                           frame.height };
+    }
+}
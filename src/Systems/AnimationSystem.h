@@ -1,12 +1,29 @@
 #ifndef ANIMATIONSYSTEM_H
 #define ANIMATIONSYSTEM_H
 
+#include "ECS/ECS.h"
+#include "Systems/UpdateRateLod.h"
 
+#include <SDL.h>
+#include <memory>
 
-class AnimationSystem {
+// Forward declaration
+class AssetStore;
 
-};
+// Advances every playing Aseprite animation and writes the current frame into `SpriteComponent::srcRect`
+// With the update rate LOD enabled, the animations far from the viewport advance every few frames.
+class AnimationSystem : public System {
+    UpdateRateLod updateRate;
+
+public:
+    AnimationSystem();
 
+    // `viewport` is the visible area, off-screen entities keep their clock running
+    // but their frame is resolved only once they become visible
+    void Update(double deltaTime, const std::unique_ptr<AssetStore>& assetStore,
+                const SDL_Rect& viewport);
 
+    UpdateRateLod& GetUpdateRate() { return updateRate; }
+};
 
-#endif //ANIMATIONSYSTEM_H
+#endif  // ANIMATIONSYSTEM_H
@@ -0,0 +1,243 @@
+#include "CollisionSystem.h"
+
+#include "Components/BoxColliderComponent.h"
+#include "Components/TransformComponent.h"
+#include "Jobs/WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+    // Below this many colliders waking the workers costs more than it saves
+    constexpr std::size_t PARALLEL_MIN_COLLIDERS = 4096;
+
+    // A sparse world gets bigger cells instead of a huge mostly empty grid
+    constexpr std::size_t MAX_CELLS_PER_COLLIDER = 4;
+    constexpr std::size_t MIN_CELLS = 1024;
+
+    // Runs on the calling thread without a worker pool, `threads` is 1 then
+    template <typename TJob>
+    void ParallelFor(WorkerPool* workers, std::size_t count, unsigned int threads, const TJob& job) {
+        if (workers)
+            workers->ParallelFor(count, threads, job);
+        else
+            job(0u, std::size_t(0), count);
+    }
+}  // namespace
+
+CollisionSystem::CollisionSystem() {
+    RequireComponent<BoxColliderComponent>();
+    RequireComponent<TransformComponent>();
+}
+
+void CollisionSystem::SetCellSize(float size) {
+    if (size > 0.0f)
+        cellSize = size;
+}
+
+void CollisionSystem::SetWorkerPool(WorkerPool* workers) {
+    this->workers = workers;
+}
+
+const std::vector<CollisionEvent>& CollisionSystem::GetCollisions() const {
+    return collisions;
+}
+
+void CollisionSystem::Update(EventBus& eventBus) {
+    FindCollisions();
+    eventBus.Publish(collisions.data(), collisions.size());
+}
+
+void CollisionSystem::FindCollisions() {
+    collisions.clear();
+
+    GatherBoxes();
+    if (boxes.size() < 2)
+        return;
+
+    const unsigned int threads =
+        workers && boxes.size() >= PARALLEL_MIN_COLLIDERS ? workers->GetThreadCount() : 1;
+    BuildGrid(threads);
+
+    const std::size_t cells = static_cast<std::size_t>(columns) * rows;
+    if (threads == 1) {
+        FindPairs(0, static_cast<int>(cells), collisions);
+        return;
+    }
+
+    // Every thread fills its own list, they are joined in cell order so the result stays deterministic
+    threadCollisions.resize(threads);
+    ParallelFor(workers, cells, threads, [this](unsigned int thread, std::size_t begin, std::size_t end) {
+        threadCollisions[thread].clear();
+        FindPairs(static_cast<int>(begin), static_cast<int>(end), threadCollisions[thread]);
+    });
+    for (const auto& events : threadCollisions)
+        collisions.insert(collisions.end(), events.begin(), events.end());
+}
+
+void CollisionSystem::GatherBoxes() {
+    const auto& entities = GetSystemEntities();
+    boxes.clear();
+    boxEntities.clear();
+
+    for (std::size_t i = 0; i < entities.size(); i++) {
+        if (!entities[i].IsActive())
+            continue;
+
+        const auto& transform = entities[i].ReadComponent<TransformComponent>();
+        const auto& collider = entities[i].ReadComponent<BoxColliderComponent>();
+
+        const float x = transform.position.x + collider.offset.x;
+        const float y = transform.position.y + collider.offset.y;
+        const float width = collider.width * transform.scale.x;
+        const float height = collider.height * transform.scale.y;
+
+        // A NaN or infinite position collides with nothing, and would break the grid bounds
+        if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(x + width) || !std::isfinite(y + height))
+            continue;
+
+        // A negative scale flips the box
+        boxes.push_back({ std::min(x, x + width), std::min(y, y + height),
+                          std::max(x, x + width), std::max(y, y + height) });
+        boxEntities.push_back(static_cast<int>(i));
+    }
+}
+
+void CollisionSystem::BuildGrid(unsigned int threads) {
+    // The grid covers the bounds of all the boxes
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    for (const auto& box : boxes) {
+        minX = std::min(minX, box.minX);
+        minY = std::min(minY, box.minY);
+        maxX = std::max(maxX, box.maxX);
+        maxY = std::max(maxY, box.maxY);
+    }
+
+    // In doubles the extent of finite boxes can't overflow, the doubling ends after at most
+    // a few hundred steps and the cell counts fit in an int
+    const std::size_t maxCells = std::max(MIN_CELLS, boxes.size() * MAX_CELLS_PER_COLLIDER);
+    const double width = static_cast<double>(maxX) - minX;
+    const double height = static_cast<double>(maxY) - minY;
+    double size = cellSize;
+    while ((std::floor(width / size) + 1.0) * (std::floor(height / size) + 1.0) > static_cast<double>(maxCells))
+        size *= 2.0;
+    columns = static_cast<int>(width / size) + 1;
+    rows = static_cast<int>(height / size) + 1;
+    originX = minX;
+    originY = minY;
+    inverseCellSize = static_cast<float>(1.0 / size);
+
+    // Counting sort, pass 1: every thread counts the cell entries of its boxes
+    const std::size_t cells = static_cast<std::size_t>(columns) * rows;
+    threadCounts.assign(threads * cells, 0);
+    ParallelFor(workers, boxes.size(), threads, [this, cells](unsigned int thread, std::size_t begin, std::size_t end) {
+        int* counts = &threadCounts[thread * cells];
+        for (std::size_t i = begin; i < end; i++) {
+            const auto& box = boxes[i];
+            const int lastX = CellX(box.maxX);
+            const int lastY = CellY(box.maxY);
+            for (int y = CellY(box.minY); y <= lastY; y++) {
+                for (int x = CellX(box.minX); x <= lastX; x++)
+                    counts[y * columns + x]++;
+            }
+        }
+    });
+
+    // Prefix sum in (cell, thread) order turns the counts into write offsets
+    cellStart.resize(cells + 1);
+    int total = 0;
+    for (std::size_t cell = 0; cell < cells; cell++) {
+        cellStart[cell] = total;
+        for (unsigned int thread = 0; thread < threads; thread++) {
+            int& count = threadCounts[thread * cells + cell];
+            const int offset = total;
+            total += count;
+            count = offset;
+        }
+    }
+    cellStart[cells] = total;
+
+    // Pass 2: same split, every thread writes its boxes at its own offsets
+    cellEntries.resize(total);
+    ParallelFor(workers, boxes.size(), threads, [this, cells](unsigned int thread, std::size_t begin, std::size_t end) {
+        int* offsets = &threadCounts[thread * cells];
+        for (std::size_t i = begin; i < end; i++) {
+            const auto& box = boxes[i];
+            const int lastX = CellX(box.maxX);
+            const int lastY = CellY(box.maxY);
+            for (int y = CellY(box.minY); y <= lastY; y++) {
+                for (int x = CellX(box.minX); x <= lastX; x++)
+                    cellEntries[offsets[y * columns + x]++] = static_cast<int>(i);
+            }
+        }
+    });
+}
+
+void CollisionSystem::FindPairs(int firstCell, int lastCell, std::vector<CollisionEvent>& events) const {
+    // Flat copies of the boxes of one cell, tested in a branch free loop the compiler can vectorize
+    thread_local std::vector<float> minX, minY, maxX, maxY;
+    thread_local std::vector<std::uint8_t> hits;
+
+    const auto& entities = GetSystemEntities();
+    for (int cell = firstCell; cell < lastCell; cell++) {
+        const int begin = cellStart[cell];
+        const int count = cellStart[cell + 1] - begin;
+        if (count < 2)
+            continue;
+
+        minX.resize(count);
+        minY.resize(count);
+        maxX.resize(count);
+        maxY.resize(count);
+        hits.resize(count);
+        for (int i = 0; i < count; i++) {
+            const auto& box = boxes[cellEntries[begin + i]];
+            minX[i] = box.minX;
+            minY[i] = box.minY;
+            maxX[i] = box.maxX;
+            maxY[i] = box.maxY;
+        }
+
+        const int cellX = cell % columns;
+        const int cellY = cell / columns;
+        for (int i = 0; i < count - 1; i++) {
+            const float aMinX = minX[i];
+            const float aMinY = minY[i];
+            const float aMaxX = maxX[i];
+            const float aMaxY = maxY[i];
+            for (int j = i + 1; j < count; j++) {
+                hits[j] = (aMinX < maxX[j]) & (minX[j] < aMaxX) & (aMinY < maxY[j]) & (minY[j] < aMaxY);
+            }
+
+            for (int j = i + 1; j < count; j++) {
+                if (!hits[j])
+                    continue;
+
+                // Boxes spanning several cells meet in all of them, only the cell
+                // of the top left corner of the overlap reports the pair
+                if (CellX(std::max(aMinX, minX[j])) != cellX || CellY(std::max(aMinY, minY[j])) != cellY)
+                    continue;
+
+                int a = cellEntries[begin + i];
+                int b = cellEntries[begin + j];
+                if (a > b)
+                    std::swap(a, b);
+                events.push_back({ entities[boxEntities[a]], entities[boxEntities[b]] });
+            }
+        }
+    }
+}
+
+// Clamped before the cast, a far out value doesn't fit in an int
+int CollisionSystem::CellX(float x) const {
+    return static_cast<int>(std::clamp((x - originX) * inverseCellSize, 0.0f, static_cast<float>(columns - 1)));
+}
+
+int CollisionSystem::CellY(float y) const {
+    return static_cast<int>(std::clamp((y - originY) * inverseCellSize, 0.0f, static_cast<float>(rows - 1)));
+}
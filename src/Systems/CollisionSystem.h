@@ -0,0 +1,69 @@
+#ifndef COLLISIONSYSTEM_H
+#define COLLISIONSYSTEM_H
+
+#include "ECS/ECS.h"
+#include "EventBus/EventBus.h"
+#include "Events/CollisionEvent.h"
+
+#include <cstddef>
+#include <vector>
+
+// Forward declaration
+class WorkerPool;
+
+// Finds the overlapping box colliders every frame.
+// Broadphase: the boxes are counting sorted into a uniform grid rebuilt every frame.
+// Narrowphase: the boxes of each cell are tested in flat arrays, a pair is reported
+// only by the cell holding the top left corner of the overlap, so there are no duplicates.
+class CollisionSystem : public System {
+    struct Box {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+    };
+
+    float cellSize = 64.0f;
+    WorkerPool* workers = nullptr;
+
+    // Broadphase grid, rebuilt every frame
+    std::vector<Box> boxes;
+    std::vector<int> boxEntities;   // [ index = box ] system entity index
+    std::vector<int> cellStart;     // [ cell ] first entry of the cell, the last value is the end
+    std::vector<int> cellEntries;   // box indexes sorted by cell
+    std::vector<int> threadCounts;  // [ thread * cells + cell ]
+    float originX = 0.0f;
+    float originY = 0.0f;
+    float inverseCellSize = 1.0f;
+    int columns = 0;
+    int rows = 0;
+
+    // Collisions of the last update, emitted in bulk
+    std::vector<CollisionEvent> collisions;
+    std::vector<std::vector<CollisionEvent>> threadCollisions;
+
+public:
+    CollisionSystem();
+
+    // Should be about the size of a typical collider
+    void SetCellSize(float size);
+
+    // Large scenes split the broadphase build and the narrowphase between the workers
+    void SetWorkerPool(WorkerPool* workers);
+
+    // Publishes the collisions of the frame to `eventBus` in one batch
+    void Update(EventBus& eventBus);
+
+    const std::vector<CollisionEvent>& GetCollisions() const;
+
+private:
+    void FindCollisions();
+    void GatherBoxes();
+    void BuildGrid(unsigned int threads);
+    void FindPairs(int firstCell, int lastCell, std::vector<CollisionEvent>& events) const;
+
+    int CellX(float x) const;
+    int CellY(float y) const;
+};
+
+#endif  // COLLISIONSYSTEM_H
@@ -0,0 +1,229 @@
+#include "HierarchySystem.h"
+
+#include "Components/ParentComponent.h"
+#include "Components/TransformComponent.h"
+#include "Jobs/WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace {
+    // Below this many children waking the workers costs more than it saves
+    constexpr std::size_t PARALLEL_MIN_NODES = 4096;
+}  // namespace
+
+HierarchySystem::HierarchySystem() {
+    RequireComponent<ParentComponent>();
+    RequireComponent<TransformComponent>();
+}
+
+void HierarchySystem::SetParent(Entity child, Entity parent) {
+    child.GetComponent<ParentComponent>().parentId = parent.GetId();
+    MarkParent(parent.GetId());
+    structureChanged = true;
+}
+
+void HierarchySystem::SetWorkerPool(WorkerPool* workers) {
+    this->workers = workers;
+}
+
+void HierarchySystem::Update() {
+    if (structureChanged) {
+        Rebuild();
+        structureChanged = false;
+    }
+
+    if (!workers || nodes.size() < PARALLEL_MIN_NODES) {
+        for (auto& subtree : subtrees)
+            UpdateSubtree(subtree);
+        return;
+    }
+
+    // Subtrees only touch their own nodes and entities
+    const unsigned int threads = std::min<std::size_t>(workers->GetThreadCount(), subtrees.size());
+    workers->ParallelFor(subtrees.size(), threads, [this](unsigned int, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++)
+            UpdateSubtree(subtrees[i]);
+    });
+}
+
+void HierarchySystem::OnEntityAdded(Entity entity) {
+    MarkParent(entity.ReadComponent<ParentComponent>().parentId);
+    structureChanged = true;
+}
+
+void HierarchySystem::OnEntityRemoved(Entity entity) {
+    structureChanged = true;
+}
+
+void HierarchySystem::OnEntityActivated(Entity entity) {
+    structureChanged = true;
+}
+
+void HierarchySystem::OnEntityDeactivated(Entity entity) {
+    structureChanged = true;
+}
+
+void HierarchySystem::OnEntityKilled(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(isParent.size()) || !isParent[id])
+        return;
+
+    // The children stay at their last world transform
+    for (auto child : GetSystemEntities()) {
+        if (child.ReadComponent<ParentComponent>().parentId == id)
+            child.GetComponent<ParentComponent>().parentId = -1;
+    }
+    isParent[id] = false;
+    structureChanged = true;
+}
+
+void HierarchySystem::MarkParent(int parentId) {
+    if (parentId < 0)
+        return;
+    if (parentId >= static_cast<int>(isParent.size()))
+        isParent.resize(parentId + 1, false);
+    isParent[parentId] = true;
+}
+
+void HierarchySystem::Rebuild() {
+    const auto& entities = GetSystemEntities();
+    nodes.clear();
+    subtrees.clear();
+    std::fill(isParent.begin(), isParent.end(), false);
+    if (entities.empty())
+        return;
+
+    // [ index = entity id ] index in `entities`, or -1 for the entities out of the system or dormant
+    int maxId = 0;
+    for (const auto& entity : entities)
+        maxId = std::max(maxId, entity.GetId());
+    std::vector<int> entityIndex(maxId + 1, -1);
+    for (std::size_t i = 0; i < entities.size(); i++) {
+        if (entities[i].IsActive())
+            entityIndex[entities[i].GetId()] = static_cast<int>(i);
+    }
+
+    // Walk up to the first ancestor without a parent, it's the root of the subtree. Entities
+    // of the system without a parent keep their transform, they are only roots.
+    std::vector<std::tuple<int, int, int>> order;  // root id, depth, index in `entities`
+    for (std::size_t i = 0; i < entities.size(); i++) {
+        const int ownParentId = entities[i].ReadComponent<ParentComponent>().parentId;
+        if (ownParentId >= 0)
+            MarkParent(ownParentId);
+        if (ownParentId < 0 || !entities[i].IsActive())
+            continue;
+
+        int current = static_cast<int>(i);
+        int depth = 0;
+        int root = -1;
+        for (;;) {
+            const int parentId = entities[current].ReadComponent<ParentComponent>().parentId;
+            if (parentId < 0) {
+                root = entities[current].GetId();
+                break;
+            }
+            if (parentId > maxId || entityIndex[parentId] < 0) {
+                root = parentId;
+                break;
+            }
+            current = entityIndex[parentId];
+            if (++depth > static_cast<int>(entities.size())) {
+                spdlog::error("Entity {} is its own ancestor, the hierarchy skips it", entities[i].GetId());
+                root = -1;
+                break;
+            }
+        }
+
+        // Detached chains have no root to follow
+        if (root >= 0)
+            order.emplace_back(root, depth, static_cast<int>(i));
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<int> entitySlot(maxId + 1, -1);
+    for (const auto& [root, depth, index] : order) {
+        if (subtrees.empty() || subtrees.back().rootId != root) {
+            const int begin = static_cast<int>(nodes.size());
+            subtrees.push_back({ root, begin, begin, 0, false, {} });
+        }
+
+        const Entity entity = entities[index];
+        const auto& parent = entity.ReadComponent<ParentComponent>();
+        const int parentSlot = parent.parentId == root ? -1 : entitySlot[parent.parentId];
+
+        entitySlot[entity.GetId()] = static_cast<int>(nodes.size());
+        nodes.push_back({ entity, parentSlot, parent.isStatic, false,
+                          { parent.localPosition, parent.localScale, parent.localRotation }, {} });
+
+        auto& subtree = subtrees.back();
+        subtree.end++;
+        if (!parent.isStatic)
+            subtree.dynamicCount++;
+    }
+}
+
+void HierarchySystem::UpdateSubtree(Subtree& subtree) {
+    // A root without a transform leaves its children where they are. A killed root detached
+    // them already, see `OnEntityKilled()`.
+    Entity root(subtree.rootId);
+    root.registry = nodes[subtree.begin].entity.registry;
+    if (!root.HasComponent<TransformComponent>())
+        return;
+
+    const auto& rootTransform = root.ReadComponent<TransformComponent>();
+    const Placement rootPlacement = { rootTransform.position, rootTransform.scale, rootTransform.rotation };
+    const bool rootMoved = !subtree.placed || rootPlacement != subtree.root;
+
+    // Static children of a root at rest cost nothing
+    if (!rootMoved && subtree.dynamicCount == 0)
+        return;
+    subtree.root = rootPlacement;
+    subtree.placed = true;
+
+    thread_local std::vector<std::uint8_t> moved;
+    moved.assign(subtree.end - subtree.begin, 0);
+
+    for (int slot = subtree.begin; slot < subtree.end; slot++) {
+        auto& node = nodes[slot];
+        bool changed = !node.placed || (node.parentSlot < 0 ? rootMoved : moved[node.parentSlot - subtree.begin]);
+
+        if (!node.isStatic) {
+            const auto& parent = node.entity.ReadComponent<ParentComponent>();
+            const Placement local = { parent.localPosition, parent.localScale, parent.localRotation };
+            if (local != node.local) {
+                node.local = local;
+                changed = true;
+            }
+        }
+
+        moved[slot - subtree.begin] = changed;
+        if (!changed)
+            continue;
+
+        const Placement& parentWorld = node.parentSlot < 0 ? subtree.root : nodes[node.parentSlot].world;
+        node.world = Combine(parentWorld, node.local);
+        node.placed = true;
+
+        auto& transform = node.entity.GetComponent<TransformComponent>();
+        transform.position = node.world.position;
+        transform.scale = node.world.scale;
+        transform.rotation = node.world.rotation;
+    }
+}
+
+HierarchySystem::Placement HierarchySystem::Combine(const Placement& parent, const Placement& local) {
+    // The local position is scaled, then rotated clockwise like the sprites, in the parent space
+    const double radians = parent.rotation * M_PI / 180.0;
+    const float cosine = static_cast<float>(std::cos(radians));
+    const float sine = static_cast<float>(std::sin(radians));
+    const glm::vec2 offset = local.position * parent.scale;
+
+    Placement world;
+    world.position = parent.position + glm::vec2(offset.x * cosine - offset.y * sine,
+                                                 offset.x * sine + offset.y * cosine);
+    world.scale = parent.scale * local.scale;
+    world.rotation = parent.rotation + local.rotation;
+    return world;
+}
@@ -0,0 +1,84 @@
+#ifndef HIERARCHYSYSTEM_H
+#define HIERARCHYSYSTEM_H
+
+#include "ECS/ECS.h"
+#include "glm/glm.hpp"
+
+#include <vector>
+
+// Forward declaration
+class WorkerPool;
+
+// Computes the world TransformComponent of the entities with a ParentComponent from their
+// local transform and the world transform of their parent. The children are kept grouped
+// by root entity and sorted by depth, so every parent is done before its children and the
+// subtrees of different roots are independent and run in parallel. A subtree is only
+// recomputed below the nodes that moved, a subtree of static children whose root didn't
+// move is skipped as a whole.
+// The root of a subtree is either an entity without a ParentComponent or one whose
+// ParentComponent has no parent. Killing a parent detaches its children, they stay where
+// they were and become roots, so they never follow an entity that reused the id. Dormant
+// entities are left out of the subtrees.
+class HierarchySystem : public System {
+    struct Placement {
+        glm::vec2 position;
+        glm::vec2 scale;
+        double rotation;
+
+        bool operator==(const Placement& other) const {
+            return position == other.position && scale == other.scale && rotation == other.rotation;
+        }
+        bool operator!=(const Placement& other) const { return !(*this == other); }
+    };
+
+    struct Node {
+        Entity entity;
+        int parentSlot;  // -1 when the parent is the root of the subtree
+        bool isStatic;
+        bool placed;  // world computed since the last rebuild
+        Placement local;  // last applied local transform
+        Placement world;
+    };
+
+    struct Subtree {
+        int rootId;
+        int begin;  // node range
+        int end;
+        int dynamicCount;  // children whose local transform can change
+        bool placed;
+        Placement root;  // world transform of the root at the last update
+    };
+
+    std::vector<Node> nodes;  // grouped by subtree, parents before children
+    std::vector<Subtree> subtrees;
+    std::vector<bool> isParent;  // [ index = entity id ] some entity of the system has it as parent
+    bool structureChanged = true;
+    WorkerPool* workers = nullptr;
+
+public:
+    HierarchySystem();
+
+    // Attaches `child` to `parent`, the local transform is kept
+    void SetParent(Entity child, Entity parent);
+
+    // Large hierarchies update their subtrees on the workers
+    void SetWorkerPool(WorkerPool* workers);
+
+    void Update();
+
+protected:
+    void OnEntityAdded(Entity entity) override;
+    void OnEntityRemoved(Entity entity) override;
+    void OnEntityKilled(Entity entity) override;
+    void OnEntityActivated(Entity entity) override;
+    void OnEntityDeactivated(Entity entity) override;
+
+private:
+    void MarkParent(int parentId);
+    void Rebuild();
+    void UpdateSubtree(Subtree& subtree);
+
+    static Placement Combine(const Placement& parent, const Placement& local);
+};
+
+#endif  // HIERARCHYSYSTEM_H
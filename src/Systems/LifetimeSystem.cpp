@@ -0,0 +1,48 @@
+#include "LifetimeSystem.h"
+
+#include "Components/LifetimeComponent.h"
+#include "EventBus/EventBus.h"
+#include "Events/LifetimeExpiredEvent.h"
+#include "Timers/TimerService.h"
+
+LifetimeSystem::LifetimeSystem(const std::unique_ptr<TimerService>& timers,
+                               const std::unique_ptr<EventBus>& eventBus)
+    : timers(timers.get()) {
+    RequireComponent<LifetimeComponent>();
+
+    eventBus->Subscribe<LifetimeExpiredEvent>([](EventBatch<LifetimeExpiredEvent> events) {
+        // Killed in the next `Registry::Update()`, the pooled ones go back to their pool
+        for (auto event : events) {
+            if (!event.entity.ReadComponent<LifetimeComponent>().pooled)
+                event.entity.Kill();
+        }
+    });
+}
+
+void LifetimeSystem::OnEntityAdded(Entity entity) {
+    if (entity.IsActive())
+        Schedule(entity);
+}
+
+void LifetimeSystem::OnEntityRemoved(Entity entity) {
+    timers->Cancel(entity.ReadComponent<LifetimeComponent>().timer);
+}
+
+void LifetimeSystem::OnEntityActivated(Entity entity) {
+    Schedule(entity);
+}
+
+void LifetimeSystem::OnEntityDeactivated(Entity entity) {
+    // Back in its pool, the next use starts a whole lifetime
+    auto& lifetime = entity.GetComponent<LifetimeComponent>();
+    timers->Cancel(lifetime.timer);
+    lifetime.expiry = -1.0;
+}
+
+void LifetimeSystem::Schedule(Entity entity) {
+    // A loaded entity keeps its expiry, on the clock of the snapshot
+    auto& lifetime = entity.GetComponent<LifetimeComponent>();
+    if (lifetime.expiry < 0.0)
+        lifetime.expiry = timers->GetTime() + lifetime.lifetime;
+    lifetime.timer = timers->Schedule(lifetime.expiry - timers->GetTime(), LifetimeExpiredEvent{ entity });
+}
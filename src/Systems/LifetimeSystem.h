@@ -0,0 +1,33 @@
+#ifndef LIFETIMESYSTEM_H
+#define LIFETIMESYSTEM_H
+
+#include "ECS/ECS.h"
+
+#include <memory>
+
+// Forward declaration
+class EventBus;
+class TimerService;
+
+// Schedules a timer for every entity with a LifetimeComponent and kills the entity through
+// the registry when it expires, unless it belongs to an EntityPool. The timer is cancelled when the entity goes away earlier,
+// so an expired timer never reaches an entity that reused the id. A dormant entity has no
+// timer, activating it starts a new one. An entity loaded from a snapshot waits until its
+// saved expiry, the TimerService clock must be set to the time of the snapshot first.
+class LifetimeSystem : public System {
+    TimerService* timers;
+
+public:
+    LifetimeSystem(const std::unique_ptr<TimerService>& timers, const std::unique_ptr<EventBus>& eventBus);
+
+protected:
+    void OnEntityAdded(Entity entity) override;
+    void OnEntityRemoved(Entity entity) override;
+    void OnEntityActivated(Entity entity) override;
+    void OnEntityDeactivated(Entity entity) override;
+
+private:
+    void Schedule(Entity entity);
+};
+
+#endif  // LIFETIMESYSTEM_H
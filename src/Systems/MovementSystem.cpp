@@ -1,2 +1,179 @@
 #include "MovementSystem.h"
 
+#include "Components/BoxColliderComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include "Components/SpriteComponent.h"
+#include "Components/TransformComponent.h"
+#include "Events/CollisionEvent.h"
+
+namespace {
+    constexpr int SLEEPING = -1;
+    constexpr int NOT_MOVED = -2;  // not in the system
+    constexpr int DORMANT = -3;
+
+    // World units per second, a slower body is at rest
+    constexpr float SLEEP_SPEED = 0.01f;
+}  // namespace
+
+MovementSystem::MovementSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<RigidBodyComponent>();
+}
+
+void MovementSystem::SetCollisionGrid(const tiled::CollisionGrid* grid) {
+    collisionGrid = grid;
+}
+
+void MovementSystem::Update(double deltaTime, Registry& registry) {
+    if (changeReader < 0)
+        changeReader = registry.TrackChanges<RigidBodyComponent>();
+    WakeChanged(registry);
+
+    updateRate.BeginFrame(deltaTime);
+
+    // Loop all the awake entities, the bodies falling asleep are swapped out of the list
+    std::size_t i = 0;
+    while (i < awake.size()) {
+        // Deactivated this frame, it leaves the list in the next `Registry::Update()`
+        if (!awake[i].IsActive()) {
+            i++;
+            continue;
+        }
+
+        const auto& rigidbody = awake[i].ReadComponent<RigidBodyComponent>();
+        if (glm::dot(rigidbody.velocity, rigidbody.velocity) < SLEEP_SPEED * SLEEP_SPEED) {
+            Sleep(i);
+            continue;
+        }
+
+        double step;
+        if (updateRate.Step(awake[i], awake[i].ReadComponent<TransformComponent>().position, step))
+            Move(awake[i], step);
+        i++;
+    }
+}
+
+void MovementSystem::WakeChanged(Registry& registry) {
+    // Only the bodies written since the last update are looked at, not the sleeping ones
+    registry.ForEachChanged<RigidBodyComponent>(changeReader, [this](Entity entity) {
+        const int id = entity.GetId();
+        if (id >= static_cast<int>(awakeSlots.size()) || awakeSlots[id] != SLEEPING)
+            return;
+
+        // Falling asleep writes the component too, it stays asleep without a velocity
+        const auto& rigidbody = entity.ReadComponent<RigidBodyComponent>();
+        if (glm::dot(rigidbody.velocity, rigidbody.velocity) >= SLEEP_SPEED * SLEEP_SPEED)
+            Wake(entity);
+    });
+}
+
+void MovementSystem::Move(Entity entity, double deltaTime) const {
+    // Get components:
+    // Get and modified
+    auto& transform = entity.GetComponent<TransformComponent>();
+    // Only get, not modified
+    const auto& rigidbody = entity.ReadComponent<RigidBodyComponent>();
+
+    const glm::vec2 delta = rigidbody.velocity * static_cast<float>(deltaTime);
+
+    // Entities with a box collider or a sprite stop at the solid tiles
+    if (collisionGrid && entity.HasComponent<BoxColliderComponent>()) {
+        const auto& collider = entity.ReadComponent<BoxColliderComponent>();
+        const glm::vec2 size(collider.width * transform.scale.x, collider.height * transform.scale.y);
+        transform.position = collisionGrid->Move(transform.position + collider.offset, size, delta) - collider.offset;
+        return;
+    }
+    if (collisionGrid && entity.HasComponent<SpriteComponent>()) {
+        const auto& sprite = entity.ReadComponent<SpriteComponent>();
+        const glm::vec2 size(sprite.width * transform.scale.x, sprite.height * transform.scale.y);
+        transform.position = collisionGrid->Move(transform.position, size, delta);
+        return;
+    }
+
+    // Update entity position based on its velocity
+    transform.position += delta;
+}
+
+void MovementSystem::SetVelocity(Entity entity, glm::vec2 velocity) {
+    entity.GetComponent<RigidBodyComponent>().velocity = velocity;
+    if (velocity != glm::vec2(0.0f))
+        Wake(entity);
+}
+
+void MovementSystem::Wake(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(awakeSlots.size()) || awakeSlots[id] != SLEEPING)
+        return;
+
+    awakeSlots[id] = static_cast<int>(awake.size());
+    awake.push_back(entity);
+    entity.GetComponent<RigidBodyComponent>().sleeping = false;
+}
+
+void MovementSystem::SubscribeToEvents(EventBus& eventBus) {
+    eventBus.Subscribe<CollisionEvent>([this](EventBatch<CollisionEvent> collisions) {
+        for (const auto& collision : collisions) {
+            Wake(collision.a);
+            Wake(collision.b);
+        }
+    });
+}
+
+void MovementSystem::OnEntityAdded(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(awakeSlots.size()))
+        awakeSlots.resize(id + 1, NOT_MOVED);
+
+    if (!entity.IsActive()) {
+        awakeSlots[id] = DORMANT;
+        return;
+    }
+
+    // New bodies start awake, they fall asleep on the first update if they don't move
+    awakeSlots[id] = SLEEPING;
+    Wake(entity);
+}
+
+void MovementSystem::OnEntityActivated(Entity entity) {
+    const int id = entity.GetId();
+    if (awakeSlots[id] != DORMANT)
+        return;
+
+    // Like a new body
+    awakeSlots[id] = SLEEPING;
+    Wake(entity);
+}
+
+void MovementSystem::OnEntityDeactivated(Entity entity) {
+    const int id = entity.GetId();
+    if (awakeSlots[id] >= 0)
+        Sleep(awakeSlots[id]);
+    awakeSlots[id] = DORMANT;
+    updateRate.Reset(entity);
+}
+
+void MovementSystem::OnEntityRemoved(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(awakeSlots.size()))
+        return;
+
+    if (awakeSlots[id] >= 0)
+        Sleep(awakeSlots[id]);
+    awakeSlots[id] = NOT_MOVED;
+    updateRate.Reset(entity);
+}
+
+void MovementSystem::Sleep(std::size_t index) {
+    const Entity entity = awake[index];
+    awakeSlots[entity.GetId()] = SLEEPING;
+    updateRate.Reset(entity);  // the time asleep is not caught up
+    if (entity.HasComponent<RigidBodyComponent>())
+        entity.GetComponent<RigidBodyComponent>().sleeping = true;
+
+    // Swap with the last one, the order of the awake bodies doesn't matter
+    if (index + 1 < awake.size()) {
+        awake[index] = awake.back();
+        awakeSlots[awake[index].GetId()] = static_cast<int>(index);
+    }
+    awake.pop_back();
+}
@@ -1,39 +1,60 @@
 #ifndef MOVEMENTSYSTEM_H
 #define MOVEMENTSYSTEM_H
 
-#include "Components/RigidBodyComponent.h"
-#include "Components/TransformComponent.h"
+#include "AssetStore/Tiled/CollisionGrid.h"
 #include "ECS/ECS.h"
+#include "EventBus/EventBus.h"
+#include "Systems/UpdateRateLod.h"
 #include "glm/glm.hpp"
 
+#include <cstdint>
 #include <vector>
 
-// Inherits from the parent class `System`
+// Moves the awake bodies by their velocity. A body whose velocity drops to zero falls
+// asleep and leaves the awake list, so the frame cost follows the bodies that move. It
+// wakes up when its RigidBodyComponent is written with a velocity, seen through the change
+// log of the registry which only holds the written bodies, or when something hits it.
+// `SetVelocity` wakes it at once.
+// With the update rate LOD enabled, the bodies far from the view move every few frames.
+// Dormant bodies are out of the awake list and nothing wakes them until they are activated.
 class MovementSystem : public System {
+    // Solid tiles of the current map, owned by the AssetStore
+    const tiled::CollisionGrid* collisionGrid = nullptr;
+
+    std::vector<Entity> awake;
+    std::vector<int> awakeSlots;  // [ entity id ] index in `awake`, SLEEPING, DORMANT or NOT_MOVED
+    UpdateRateLod updateRate;
+
+    // Of the RigidBodyComponent change log, see `Registry::TrackChanges()`
+    int changeReader = -1;
+
 public:
-    MovementSystem() {
-        RequireComponent<TransformComponent>();
-        RequireComponent<RigidBodyComponent>();
-    }
-
-    void Update(double deltaTime) {
-        // Loop all entities that the system is interested in
-        for (auto entity : GetSystemEntities()) {
-            // Get components:
-            // Get and modified
-            auto& transform = entity.GetComponent<TransformComponent>();
-            // Only get, not modified
-            const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
-
-            // Update entity position based on its velocity
-            transform.position.x += rigidbody.velocity.x * deltaTime;
-            transform.position.y += rigidbody.velocity.y * deltaTime;
-
-            // Logger::Log("Entity id = " + std::to_string(entity.GetId()) + " position is now ("
-            //             + std::to_string(transform.position.x) + ", "
-            //             + std::to_string(transform.position.y) + ")");
-        }
-    }
+    MovementSystem();
+
+    void SetCollisionGrid(const tiled::CollisionGrid* grid);
+
+    void Update(double deltaTime, Registry& registry);
+
+    // Sets the velocity and wakes the body up when it moves
+    void SetVelocity(Entity entity, glm::vec2 velocity);
+    void Wake(Entity entity);
+
+    // A sleeping body hit by another one wakes up
+    void SubscribeToEvents(EventBus& eventBus);
+
+    const std::vector<Entity>& GetAwakeEntities() const { return awake; }
+    UpdateRateLod& GetUpdateRate() { return updateRate; }
+
+protected:
+    void OnEntityAdded(Entity entity) override;
+    void OnEntityRemoved(Entity entity) override;
+    void OnEntityActivated(Entity entity) override;
+    void OnEntityDeactivated(Entity entity) override;
+
+private:
+    void WakeChanged(Registry& registry);
+    void Move(Entity entity, double deltaTime) const;
+    void Sleep(std::size_t index);
 };
 
 #endif  // MOVEMENTSYSTEM_H
@@ -0,0 +1,237 @@
+#include "PathfindingSystem.h"
+
+#include "Components/BoxColliderComponent.h"
+#include "Components/PathComponent.h"
+#include "Components/RigidBodyComponent.h"
+#include "Components/TransformComponent.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+    // From this many units asking for the same goal tile in one frame, they share a flow field
+    constexpr int FLOW_FIELD_MIN_UNITS = 8;
+
+    // Fraction of a tile, a waypoint closer than this is reached
+    constexpr float WAYPOINT_RADIUS = 0.25f;
+
+    // World units, the target closer than this is reached
+    constexpr float ARRIVE_DISTANCE = 2.0f;
+
+    // Distance from `point` to the segment [a, b]
+    float SegmentDistance(glm::vec2 a, glm::vec2 b, glm::vec2 point) {
+        const glm::vec2 segment = b - a;
+        const float lengthSquared = glm::dot(segment, segment);
+        const float t =
+            lengthSquared > 0.0f ? glm::clamp(glm::dot(point - a, segment) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+        return glm::length(a + segment * t - point);
+    }
+
+    // Written only when it changes, a unit standing still doesn't stamp its RigidBodyComponent
+    void SetVelocity(Entity entity, glm::vec2 velocity) {
+        if (entity.ReadComponent<RigidBodyComponent>().velocity != velocity)
+            entity.GetComponent<RigidBodyComponent>().velocity = velocity;
+    }
+}  // namespace
+
+PathfindingSystem::PathfindingSystem() {
+    RequireComponent<PathComponent>();
+    RequireComponent<TransformComponent>();
+    RequireComponent<RigidBodyComponent>();
+
+    // The main thread keeps running the game
+    const unsigned int threads = std::thread::hardware_concurrency();
+    pathfinder = std::make_unique<Pathfinder>(threads > 1 ? threads - 1 : 1);
+}
+
+void PathfindingSystem::SetCollisionGrid(const tiled::CollisionGrid* grid) {
+    collisionGrid = grid;
+
+    // The hierarchical graph of a new map is built here, at load time, instead of in a frame
+    if (collisionGrid)
+        pathfinder->SetGrid(*collisionGrid);
+}
+
+void PathfindingSystem::SetMovementSystem(MovementSystem* system) {
+    movementSystem = system;
+}
+
+void PathfindingSystem::SetFrameBudget(std::size_t requests, std::size_t results) {
+    requestsPerFrame = std::max<std::size_t>(1, requests);
+    resultsPerFrame = std::max<std::size_t>(1, results);
+}
+
+void PathfindingSystem::Update() {
+    if (!collisionGrid)
+        return;
+
+    // Copies the grid only when tiles changed, the routes built before are then out of date
+    pathfinder->SetGrid(*collisionGrid);
+
+    ApplyResults();
+    RequestRoutes();
+
+    for (auto entity : GetSystemEntities()) {
+        if (entity.IsActive())
+            Steer(entity);
+    }
+}
+
+void PathfindingSystem::RequestRoutes() {
+    const std::uint32_t gridVersion = pathfinder->GetGridVersion();
+
+    needRoute.clear();
+    goalUnits.clear();
+    for (auto entity : GetSystemEntities()) {
+        if (!entity.IsActive())
+            continue;
+
+        const auto& path = entity.ReadComponent<PathComponent>();
+        const glm::ivec2 goal = collisionGrid->WorldToCell(path.target);
+
+        // A new target drops the old route, the only write of the frame for most units
+        if (goal != path.goalCell) {
+            auto& reset = entity.GetComponent<PathComponent>();
+            reset.goalCell = goal;
+            reset.path.reset();
+            reset.flowField.reset();
+            reset.requestId = 0;
+            reset.arrived = false;
+        }
+
+        if (path.requestId != 0 || path.arrived)
+            continue;
+
+        // Out of date routes are still followed until the new one arrives
+        const bool hasRoute = path.path || path.flowField;
+        if (hasRoute && path.gridVersion == gridVersion)
+            continue;
+
+        needRoute.push_back(entity);
+        goalUnits[CellKey(goal)]++;
+    }
+
+    // Requests past the budget are sent on the next frames
+    std::size_t requests = 0;
+    flowFieldRequests.clear();
+    for (auto entity : needRoute) {
+        auto& path = entity.GetComponent<PathComponent>();
+        const std::int64_t goalKey = CellKey(path.goalCell);
+
+        std::uint32_t id = 0;
+        if (goalUnits[goalKey] >= FLOW_FIELD_MIN_UNITS) {
+            auto request = flowFieldRequests.find(goalKey);
+            if (request != flowFieldRequests.end()) {
+                id = request->second;
+            } else if (requests < requestsPerFrame) {
+                id = pathfinder->FindFlowField(path.goalCell);
+                flowFieldRequests.emplace(goalKey, id);
+                requests++;
+            }
+        } else if (requests < requestsPerFrame) {
+            id = pathfinder->FindPath(collisionGrid->WorldToCell(GetCenter(entity)), path.goalCell);
+            requests++;
+        }
+
+        if (id != 0) {
+            path.requestId = id;
+            waiting[id].push_back(entity);
+        }
+    }
+}
+
+void PathfindingSystem::ApplyResults() {
+    results.clear();
+    pathfinder->TakeResults(results, resultsPerFrame);
+
+    for (const auto& result : results) {
+        auto entities = waiting.find(result.id);
+        if (entities == waiting.end())
+            continue;
+
+        for (auto entity : entities->second) {
+            // Killed entities and entities sent somewhere else meanwhile don't want it anymore
+            if (!entity.HasComponent<PathComponent>())
+                continue;
+            auto& path = entity.GetComponent<PathComponent>();
+            if (path.requestId != result.id)
+                continue;
+
+            path.requestId = 0;
+            path.gridVersion = result.gridVersion;
+            path.path = result.path;
+            path.flowField = result.flowField;
+            path.nextWaypoint = 1;  // the first tile is the one the unit stands on
+            path.previousCenter = GetCenter(entity);
+        }
+        waiting.erase(entities);
+    }
+}
+
+void PathfindingSystem::Steer(Entity entity) const {
+    // Idle units are only read
+    const auto& route = entity.ReadComponent<PathComponent>();
+    if (route.arrived || (!route.path && !route.flowField)) {
+        SetVelocity(entity, glm::vec2(0.0f));
+        return;
+    }
+
+    auto& path = entity.GetComponent<PathComponent>();
+
+    const glm::vec2 center = GetCenter(entity);
+    const glm::vec2 previousCenter = path.previousCenter;
+    path.previousCenter = center;
+    const glm::ivec2 cell = collisionGrid->WorldToCell(center);
+    const glm::vec2 cellSize = collisionGrid->GetCellSize();
+    const float waypointRadius = WAYPOINT_RADIUS * std::min(cellSize.x, cellSize.y);
+
+    // Head for the middle of the next tile, and for the target itself on the goal tile
+    glm::vec2 waypoint = path.target;
+    if (path.flowField) {
+        if (cell != path.goalCell) {
+            const glm::ivec2 direction = path.flowField->GetDirection(cell);
+            if (direction == glm::ivec2(0)) {
+                SetVelocity(entity, glm::vec2(0.0f));
+                return;
+            }
+            waypoint = collisionGrid->CellCenter(cell + direction);
+        }
+    } else {
+        const auto& tiles = *path.path;
+        if (tiles.empty()) {
+            SetVelocity(entity, glm::vec2(0.0f));
+            return;
+        }
+        while (path.nextWaypoint < tiles.size()
+               && glm::length(collisionGrid->CellCenter(tiles[path.nextWaypoint]) - center) < waypointRadius)
+            path.nextWaypoint++;
+        if (path.nextWaypoint < tiles.size())
+            waypoint = collisionGrid->CellCenter(tiles[path.nextWaypoint]);
+    }
+
+    const glm::vec2 offset = waypoint - center;
+    const float distance = glm::length(offset);
+    // Bodies far from the view move every few frames, they arrive when they went past the target
+    if (waypoint == path.target && SegmentDistance(previousCenter, center, path.target) < ARRIVE_DISTANCE) {
+        path.arrived = true;
+        SetVelocity(entity, glm::vec2(0.0f));
+        return;
+    }
+    SetVelocity(entity, distance > 0.0f ? offset * (path.speed / distance) : glm::vec2(0.0f));
+    if (entity.ReadComponent<RigidBodyComponent>().sleeping && movementSystem)
+        movementSystem->Wake(entity);
+}
+
+glm::vec2 PathfindingSystem::GetCenter(Entity entity) {
+    const auto& transform = entity.ReadComponent<TransformComponent>();
+    if (!entity.HasComponent<BoxColliderComponent>())
+        return transform.position;
+
+    const auto& collider = entity.ReadComponent<BoxColliderComponent>();
+    return transform.position + collider.offset
+           + glm::vec2(collider.width, collider.height) * transform.scale * 0.5f;
+}
+
+std::int64_t PathfindingSystem::CellKey(glm::ivec2 cell) {
+    return (static_cast<std::int64_t>(cell.x) << 32) | static_cast<std::uint32_t>(cell.y);
+}
@@ -0,0 +1,59 @@
+#ifndef PATHFINDINGSYSTEM_H
+#define PATHFINDINGSYSTEM_H
+
+#include "AssetStore/Tiled/CollisionGrid.h"
+#include "ECS/ECS.h"
+#include "Pathfinding/Pathfinder.h"
+#include "Systems/MovementSystem.h"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Steers the entities with a PathComponent to their target. The routes are searched by
+// the Pathfinder workers, the frame only sends a few requests and takes a few results.
+// Units sharing a goal tile follow one flow field, the others get their own A* path.
+class PathfindingSystem : public System {
+    // Solid tiles of the current map, owned by the AssetStore
+    const tiled::CollisionGrid* collisionGrid = nullptr;
+    // Wakes up the sleeping units sent somewhere
+    MovementSystem* movementSystem = nullptr;
+    std::unique_ptr<Pathfinder> pathfinder;
+
+    // Per frame budget
+    std::size_t requestsPerFrame = 64;
+    std::size_t resultsPerFrame = 256;
+
+    std::unordered_map<std::uint32_t, std::vector<Entity>> waiting;  // request id -> entities
+
+    // Reused every frame
+    std::vector<Entity> needRoute;
+    std::unordered_map<std::int64_t, int> goalUnits;  // goal tile -> units asking for it
+    std::unordered_map<std::int64_t, std::uint32_t> flowFieldRequests;  // goal tile -> request id
+    std::vector<PathResult> results;
+
+public:
+    PathfindingSystem();
+
+    void SetCollisionGrid(const tiled::CollisionGrid* grid);
+    void SetMovementSystem(MovementSystem* system);
+
+    // How many searches are queued and how many finished routes are handed out per frame
+    void SetFrameBudget(std::size_t requests, std::size_t results);
+
+    void Update();
+
+private:
+    void RequestRoutes();
+    void ApplyResults();
+    void Steer(Entity entity) const;
+
+    // Routes follow the middle of the collider, or the position without one
+    static glm::vec2 GetCenter(Entity entity);
+    static std::int64_t CellKey(glm::ivec2 cell);
+};
+
+#endif  // PATHFINDINGSYSTEM_H
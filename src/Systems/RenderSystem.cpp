@@ -3,26 +3,48 @@
 #include "AssetStore/AssetStore.h"
 #include "Components/SpriteComponent.h"
 #include "Components/TransformComponent.h"
+#include "Particles/ParticleSystem.h"
 
 #include <SDL.h>
 #include <glm/glm.hpp>
 #include <tmxlite/Map.hpp>
 #include <vector>
 
-RenderSystem::RenderSystem() {
+RenderSystem::RenderSystem(const std::unique_ptr<AssetStore>& assetStore)
+    : assetStore(assetStore.get()) {
     RequireComponent<SpriteComponent>();
     RequireComponent<TransformComponent>();
 }
 
+void RenderSystem::SetParticleSystem(ParticleSystem* particles) {
+    this->particles = particles;
+}
+
+void RenderSystem::OnEntityAdded(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(retainedAssets.size()))
+        retainedAssets.resize(id + 1);
+
+    retainedAssets[id] = entity.ReadComponent<SpriteComponent>().assetId;
+    assetStore->RetainAsset(retainedAssets[id]);
+}
+
+void RenderSystem::OnEntityRemoved(Entity entity) {
+    // The sprite may point at another asset by now, release the one that was retained
+    auto& retained = retainedAssets[entity.GetId()];
+    assetStore->ReleaseAsset(retained);
+    retained.clear();
+}
+
 void RenderSystem::Update(SDL_Renderer* renderer, const std::unique_ptr<AssetStore>& assetStore) {
     SortEntitiesIntoBuckets();
 
     // Loop all sorted entities that the system is interested in
-    for (auto & renderBucket : renderBuckets) {
-        for (auto entity : renderBucket) {
-            const auto transform = entity.GetComponent<TransformComponent>();
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        for (auto entity : renderBuckets[layer]) {
+            const auto transform = entity.ReadComponent<TransformComponent>();
 
-            switch (const auto& sprite = entity.GetComponent<SpriteComponent>(); sprite.spriteType) {
+            switch (const auto& sprite = entity.ReadComponent<SpriteComponent>(); sprite.spriteType) {
                 case SpriteType::SPRITE:
                     UpdateSprites(renderer, assetStore, transform, sprite);
                 break;
@@ -31,6 +53,9 @@ void RenderSystem::Update(SDL_Renderer* renderer, const std::unique_ptr<AssetSto
                 break;
             }
         }
+
+        if (particles)
+            particles->Render(renderer, static_cast<RenderLayers>(layer));
     }
 }
 
@@ -40,10 +65,21 @@ void RenderSystem::SortEntitiesIntoBuckets() {
         renderBucket.clear();
     }
 
-    // Assign each entity to its bucket
+    // Assign each entity to its bucket, the dormant ones keep their asset but aren't drawn
     for (auto entity : GetSystemEntities()) {
-        auto& sprite = entity.GetComponent<SpriteComponent>();
+        if (!entity.IsActive())
+            continue;
+
+        const auto& sprite = entity.ReadComponent<SpriteComponent>();
         renderBuckets[sprite.layer].push_back(entity);
+
+        // A sprite switched to another asset moves its reference over
+        auto& retained = retainedAssets[entity.GetId()];
+        if (retained != sprite.assetId) {
+            assetStore->RetainAsset(sprite.assetId);
+            assetStore->ReleaseAsset(retained);
+            retained = sprite.assetId;
+        }
     }
 }
 
@@ -83,7 +119,7 @@ void RenderSystem::UpdateTiles(SDL_Renderer* renderer, const std::unique_ptr<Ass
                          static_cast<int>(width * transform.scale.x),
                          static_cast<int>(height * transform.scale.y) };
 
-    const auto layers = assetStore->GetTmxLayers(sprite.assetId);
+    const auto& layers = assetStore->GetTmxLayers(sprite.assetId);
 
     for (size_t i = 0U; i < layers.size(); i++) {
         bool isLayerValid = sprite.tileLayerIndexes.empty()
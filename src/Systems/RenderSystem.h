@@ -5,20 +5,33 @@
 #include "ECS/ECS.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 // Forward declaration
 struct SpriteComponent;
 struct TransformComponent;
 struct SDL_Renderer;
 class AssetStore;
+class ParticleSystem;
 
 // Inherits from the parent class `System`
 class RenderSystem : public System {
     std::vector<Entity> renderBuckets[LAYER_COUNT];
+    AssetStore* assetStore;  // keeps the assets of the rendered entities alive
+    std::vector<std::string> retainedAssets;  // [ entity id ] asset retained for the entity
+    ParticleSystem* particles = nullptr;
 public:
-    RenderSystem();
+    explicit RenderSystem(const std::unique_ptr<AssetStore>& assetStore);
+
+    // The particles of a layer are drawn over its sprites
+    void SetParticleSystem(ParticleSystem* particles);
     void Update(SDL_Renderer* renderer, const std::unique_ptr<AssetStore>& assetStore);
 
+protected:
+    void OnEntityAdded(Entity entity) override;
+    void OnEntityRemoved(Entity entity) override;
+
 private:
     void SortEntitiesIntoBuckets();
     void UpdateSprites(SDL_Renderer* renderer, const std::unique_ptr<AssetStore>& assetStore, const TransformComponent& t, const SpriteComponent& s);
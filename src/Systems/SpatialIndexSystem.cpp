@@ -0,0 +1,293 @@
+#include "SpatialIndexSystem.h"
+
+#include "Components/TransformComponent.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialIndexSystem::SpatialIndexSystem() {
+    RequireComponent<TransformComponent>();
+}
+
+void SpatialIndexSystem::SetCellSize(float size) {
+    if (size <= 0.0f)
+        return;
+
+    cellSize = size;
+    inverseCellSize = 1.0f / size;
+
+    // Every entity changes cell
+    cells.clear();
+    minCell = glm::ivec2(std::numeric_limits<int>::max());
+    maxCell = glm::ivec2(std::numeric_limits<int>::min());
+    boundsStale = false;
+    for (int slot = 0; slot < static_cast<int>(slots.size()); slot++)
+        Insert(slot, CellOf(slots[slot].position));
+}
+
+void SpatialIndexSystem::Update(Registry& registry) {
+    const std::uint32_t since = lastChangeTick;
+    lastChangeTick = registry.TakeChangeTick();
+
+    for (int slot = 0; slot < static_cast<int>(slots.size()); slot++) {
+        auto& item = slots[slot];
+        if (!item.entity.HasChanged<TransformComponent>(since))
+            continue;
+        item.position = item.entity.ReadComponent<TransformComponent>().position;
+
+        // Only the entities that crossed a cell border touch the grid
+        const glm::ivec2 cell = CellOf(item.position);
+        if (CellKey(cell.x, cell.y) != item.cell) {
+            Remove(slot);
+            Insert(slot, cell);
+        }
+    }
+}
+
+EntitySpan SpatialIndexSystem::QueryRect(glm::vec2 min, glm::vec2 max) {
+    results.clear();
+
+    const auto inside = [&](const Slot& item) {
+        return item.entity.IsActive() && item.position.x >= min.x && item.position.x <= max.x && item.position.y >= min.y
+               && item.position.y <= max.y;
+    };
+
+    const glm::ivec2 first = CellOf(min);
+    const glm::ivec2 last = CellOf(max);
+    const double rangeCells = (double(last.x) - first.x + 1) * (double(last.y) - first.y + 1);
+
+    // A rectangle covering more cells than exist is cheaper to answer by scanning every entity
+    if (rangeCells > static_cast<double>(cells.size())) {
+        for (const auto& item : slots) {
+            if (inside(item))
+                results.push_back(item.entity);
+        }
+        return MakeSpan();
+    }
+
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            auto cell = cells.find(CellKey(x, y));
+            if (cell == cells.end())
+                continue;
+            for (const int slot : cell->second) {
+                if (inside(slots[slot]))
+                    results.push_back(slots[slot].entity);
+            }
+        }
+    }
+    return MakeSpan();
+}
+
+EntitySpan SpatialIndexSystem::QueryRadius(glm::vec2 center, float radius) {
+    results.clear();
+    if (radius < 0.0f)
+        return MakeSpan();
+
+    const float radiusSquared = radius * radius;
+    const glm::ivec2 first = CellOf(center - glm::vec2(radius));
+    const glm::ivec2 last = CellOf(center + glm::vec2(radius));
+    const double rangeCells = (double(last.x) - first.x + 1) * (double(last.y) - first.y + 1);
+
+    if (rangeCells > static_cast<double>(cells.size())) {
+        for (const auto& item : slots) {
+            const glm::vec2 offset = item.position - center;
+            if (glm::dot(offset, offset) <= radiusSquared && item.entity.IsActive())
+                results.push_back(item.entity);
+        }
+        return MakeSpan();
+    }
+
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            auto cell = cells.find(CellKey(x, y));
+            if (cell == cells.end())
+                continue;
+            for (const int slot : cell->second) {
+                const glm::vec2 offset = slots[slot].position - center;
+                if (glm::dot(offset, offset) <= radiusSquared && slots[slot].entity.IsActive())
+                    results.push_back(slots[slot].entity);
+            }
+        }
+    }
+    return MakeSpan();
+}
+
+EntitySpan SpatialIndexSystem::QueryNearest(glm::vec2 center, std::size_t count, float maxDistance) {
+    results.clear();
+    nearest.clear();
+    if (count == 0 || slots.empty() || maxDistance < 0.0f)
+        return MakeSpan();
+
+    const float maxDistanceSquared =
+        maxDistance < std::sqrt(std::numeric_limits<float>::max()) ? maxDistance * maxDistance
+                                                                    : std::numeric_limits<float>::max();
+
+    if (boundsStale)
+        RefreshBounds();
+
+    // Search rings of cells around the center cell. Every entity of the ring `r + 1` is at least
+    // `r * cellSize` away, so the search stops once the nearest list is full and closer than that.
+    // The rings start at the occupied bounds and only their part inside the bounds is visited.
+    const glm::ivec2 origin = CellOf(center);
+    const std::int64_t boundsDistance =
+        std::max({ std::int64_t(0), std::int64_t(minCell.x) - origin.x, std::int64_t(origin.x) - maxCell.x,
+                   std::int64_t(minCell.y) - origin.y, std::int64_t(origin.y) - maxCell.y });
+    if (boundsDistance * static_cast<double>(cellSize) > maxDistance + cellSize)
+        return MakeSpan();
+
+    for (int ring = static_cast<int>(boundsDistance);; ring++) {
+        if (ring == 0) {
+            GatherNearest(origin.x, origin.y, center, count, maxDistanceSquared);
+        } else {
+            const int firstX = std::max(origin.x - ring, minCell.x);
+            const int lastX = std::min(origin.x + ring, maxCell.x);
+            for (const int y : { origin.y - ring, origin.y + ring }) {
+                if (y < minCell.y || y > maxCell.y)
+                    continue;
+                for (int x = firstX; x <= lastX; x++)
+                    GatherNearest(x, y, center, count, maxDistanceSquared);
+            }
+
+            const int firstY = std::max(origin.y - ring + 1, minCell.y);
+            const int lastY = std::min(origin.y + ring - 1, maxCell.y);
+            for (const int x : { origin.x - ring, origin.x + ring }) {
+                if (x < minCell.x || x > maxCell.x)
+                    continue;
+                for (int y = firstY; y <= lastY; y++)
+                    GatherNearest(x, y, center, count, maxDistanceSquared);
+            }
+        }
+
+        const float reached = ring * cellSize;
+        if (nearest.size() == count && nearest.back().first <= reached * reached)
+            break;
+        if (reached > maxDistance)
+            break;
+        if (origin.x - ring <= minCell.x && origin.x + ring >= maxCell.x && origin.y - ring <= minCell.y
+            && origin.y + ring >= maxCell.y)
+            break;
+    }
+
+    for (const auto& [distance, slot] : nearest)
+        results.push_back(slots[slot].entity);
+    return MakeSpan();
+}
+
+void SpatialIndexSystem::OnEntityAdded(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(entitySlots.size()))
+        entitySlots.resize(id + 1, -1);
+
+    const glm::vec2 position = entity.ReadComponent<TransformComponent>().position;
+    const int slot = static_cast<int>(slots.size());
+    slots.push_back({ entity, position, 0, 0 });
+    entitySlots[id] = slot;
+    Insert(slot, CellOf(position));
+}
+
+void SpatialIndexSystem::OnEntityRemoved(Entity entity) {
+    const int id = entity.GetId();
+    if (id >= static_cast<int>(entitySlots.size()) || entitySlots[id] < 0)
+        return;
+
+    const int slot = entitySlots[id];
+    Remove(slot);
+
+    // Move the last slot into the hole
+    const int last = static_cast<int>(slots.size()) - 1;
+    if (slot != last) {
+        slots[slot] = slots[last];
+        cells[slots[slot].cell][slots[slot].indexInCell] = slot;
+        entitySlots[slots[slot].entity.GetId()] = slot;
+    }
+    slots.pop_back();
+    entitySlots[id] = -1;
+}
+
+glm::ivec2 SpatialIndexSystem::CellOf(glm::vec2 position) const {
+    return glm::ivec2(static_cast<int>(std::floor(position.x * inverseCellSize)),
+                      static_cast<int>(std::floor(position.y * inverseCellSize)));
+}
+
+std::int64_t SpatialIndexSystem::CellKey(int x, int y) {
+    return (static_cast<std::int64_t>(x) << 32) | static_cast<std::uint32_t>(y);
+}
+
+void SpatialIndexSystem::Insert(int slot, glm::ivec2 cell) {
+    auto& item = slots[slot];
+    item.cell = CellKey(cell.x, cell.y);
+
+    auto& entries = cells[item.cell];
+    item.indexInCell = static_cast<int>(entries.size());
+    entries.push_back(slot);
+
+    minCell = glm::min(minCell, cell);
+    maxCell = glm::max(maxCell, cell);
+}
+
+void SpatialIndexSystem::Remove(int slot) {
+    auto& entries = cells[slots[slot].cell];
+    const int index = slots[slot].indexInCell;
+
+    // Swap with the last entry of the cell
+    const int moved = entries.back();
+    entries[index] = moved;
+    slots[moved].indexInCell = index;
+    entries.pop_back();
+
+    // A bound may have moved in
+    if (entries.empty()) {
+        const int x = static_cast<int>(slots[slot].cell >> 32);
+        const int y = static_cast<int>(static_cast<std::uint32_t>(slots[slot].cell));
+        if (x == minCell.x || x == maxCell.x || y == minCell.y || y == maxCell.y)
+            boundsStale = true;
+    }
+}
+
+void SpatialIndexSystem::RefreshBounds() {
+    minCell = glm::ivec2(std::numeric_limits<int>::max());
+    maxCell = glm::ivec2(std::numeric_limits<int>::min());
+    for (auto cell = cells.begin(); cell != cells.end();) {
+        if (cell->second.empty()) {
+            cell = cells.erase(cell);
+            continue;
+        }
+        const glm::ivec2 position(static_cast<int>(cell->first >> 32),
+                                  static_cast<int>(static_cast<std::uint32_t>(cell->first)));
+        minCell = glm::min(minCell, position);
+        maxCell = glm::max(maxCell, position);
+        ++cell;
+    }
+    boundsStale = false;
+}
+
+void SpatialIndexSystem::GatherNearest(int x, int y, glm::vec2 center, std::size_t count,
+                                       float maxDistanceSquared) {
+    if (x < minCell.x || x > maxCell.x || y < minCell.y || y > maxCell.y)
+        return;
+
+    auto cell = cells.find(CellKey(x, y));
+    if (cell == cells.end())
+        return;
+
+    for (const int slot : cell->second) {
+        const glm::vec2 offset = slots[slot].position - center;
+        const float distance = glm::dot(offset, offset);
+        if (distance > maxDistanceSquared || !slots[slot].entity.IsActive())
+            continue;
+        if (nearest.size() == count) {
+            if (distance >= nearest.back().first)
+                continue;
+            nearest.pop_back();
+        }
+
+        // The list is short, keep it sorted by insertion
+        const std::pair<float, int> candidate(distance, slot);
+        nearest.insert(std::upper_bound(nearest.begin(), nearest.end(), candidate), candidate);
+    }
+}
+
+EntitySpan SpatialIndexSystem::MakeSpan() {
+    return { results.data(), results.size() };
+}
@@ -0,0 +1,96 @@
+#ifndef SPATIALINDEXSYSTEM_H
+#define SPATIALINDEXSYSTEM_H
+
+#include "ECS/ECS.h"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Non-owning view of query results, valid until the next query
+struct EntitySpan {
+    const Entity* data = nullptr;
+    std::size_t size = 0;
+
+    const Entity* begin() const { return data; }
+    const Entity* end() const { return data + size; }
+    bool empty() const { return size == 0; }
+    const Entity& operator[](std::size_t index) const { return data[index]; }
+};
+
+// Uniform hash grid over the TransformComponent positions, for AI, radar, culling and triggers.
+// `Update()` looks only at the transforms changed since the last update and moves the entities
+// that changed cell, queries see the positions of the last update.
+// The query results live in buffers reused between the queries, so a warm index doesn't allocate.
+// Dormant entities stay indexed and are left out of the results.
+class SpatialIndexSystem : public System {
+    struct Slot {
+        Entity entity;
+        glm::vec2 position;
+        std::int64_t cell;
+        int indexInCell;
+    };
+
+    float cellSize = 128.0f;
+    float inverseCellSize = 1.0f / 128.0f;
+
+    // `Registry::TakeChangeTick()` of the last update
+    std::uint32_t lastChangeTick = 0;
+
+    std::vector<Slot> slots;
+    std::vector<int> entitySlots;  // [ index = entity id ] slot index or -1
+    std::unordered_map<std::int64_t, std::vector<int>> cells;  // slot indexes, empty cells are kept
+
+    // Occupied cell bounds, nearest queries stop at them. They grow with the inserts, and are
+    // recomputed by the next nearest query once a cell on their border empties.
+    glm::ivec2 minCell = glm::ivec2(std::numeric_limits<int>::max());
+    glm::ivec2 maxCell = glm::ivec2(std::numeric_limits<int>::min());
+    bool boundsStale = false;
+
+    // Reused query buffers
+    std::vector<Entity> results;
+    std::vector<std::pair<float, int>> nearest;
+
+public:
+    SpatialIndexSystem();
+
+    // Should be about the size of a typical query, the index is rebuilt
+    void SetCellSize(float size);
+
+    void Update(Registry& registry);
+
+    // Entities inside the rectangle, borders included
+    EntitySpan QueryRect(glm::vec2 min, glm::vec2 max);
+
+    // Entities inside the circle, border included
+    EntitySpan QueryRadius(glm::vec2 center, float radius);
+
+    // Up to `count` entities closest to `center` within `maxDistance`, closest first
+    EntitySpan QueryNearest(glm::vec2 center, std::size_t count,
+                            float maxDistance = std::numeric_limits<float>::max());
+
+protected:
+    void OnEntityAdded(Entity entity) override;
+    void OnEntityRemoved(Entity entity) override;
+
+private:
+    glm::ivec2 CellOf(glm::vec2 position) const;
+    static std::int64_t CellKey(int x, int y);
+
+    void Insert(int slot, glm::ivec2 cell);
+    void Remove(int slot);
+
+    // Bounds of the non-empty cells, the empty cells are dropped on the way
+    void RefreshBounds();
+
+    // Tests the entities of one cell against the current nearest list
+    void GatherNearest(int x, int y, glm::vec2 center, std::size_t count, float maxDistanceSquared);
+
+    EntitySpan MakeSpan();
+};
+
+#endif  // SPATIALINDEXSYSTEM_H
@@ -0,0 +1,78 @@
+#include "UpdateRateLod.h"
+
+#include <algorithm>
+
+namespace {
+    // Off-screen by more than a sprite: every other frame, then slower and slower
+    const std::vector<UpdateRateLod::Tier> DEFAULT_TIERS = { { 128.0f, 2 }, { 1024.0f, 4 }, { 4096.0f, 8 } };
+}  // namespace
+
+UpdateRateLod::UpdateRateLod() : tiers(DEFAULT_TIERS) {}
+
+void UpdateRateLod::SetEnabled(bool enabled) {
+    this->enabled = enabled;
+    lastSteps.clear();
+}
+
+void UpdateRateLod::SetTiers(std::vector<Tier> tiers) {
+    std::sort(tiers.begin(), tiers.end(),
+              [](const Tier& a, const Tier& b) { return a.distance < b.distance; });
+    this->tiers = std::move(tiers);
+}
+
+void UpdateRateLod::SetView(const SDL_Rect& view) {
+    this->view = view;
+}
+
+void UpdateRateLod::BeginFrame(double deltaTime) {
+    this->deltaTime = deltaTime;
+    clock += deltaTime;
+    frame++;
+}
+
+bool UpdateRateLod::Step(Entity entity, glm::vec2 position, double& elapsed) {
+    if (!enabled) {
+        elapsed = deltaTime;
+        return true;
+    }
+
+    const auto id = static_cast<std::size_t>(entity.GetId());
+    if (id >= lastSteps.size())
+        lastSteps.resize(id + 1, -1.0);
+
+    // A new entity starts with the current frame
+    double& lastStep = lastSteps[id];
+    if (lastStep < 0.0)
+        lastStep = clock - deltaTime;
+
+    // The id picks the bucket, so the entities of a tier don't all update on the same frame
+    const int period = GetPeriod(position);
+    if (period > 1 && (frame + id) % period != 0)
+        return false;
+
+    elapsed = clock - lastStep;
+    lastStep = clock;
+    return true;
+}
+
+void UpdateRateLod::Reset(Entity entity) {
+    const auto id = static_cast<std::size_t>(entity.GetId());
+    if (id < lastSteps.size())
+        lastSteps[id] = -1.0;
+}
+
+int UpdateRateLod::GetPeriod(glm::vec2 position) const {
+    const float dx = std::max({ static_cast<float>(view.x) - position.x, 0.0f,
+                                position.x - static_cast<float>(view.x + view.w) });
+    const float dy = std::max({ static_cast<float>(view.y) - position.y, 0.0f,
+                                position.y - static_cast<float>(view.y + view.h) });
+    const float distanceSquared = dx * dx + dy * dy;
+
+    int period = 1;
+    for (const auto& tier : tiers) {
+        if (distanceSquared <= tier.distance * tier.distance)
+            break;
+        period = tier.period;
+    }
+    return period;
+}
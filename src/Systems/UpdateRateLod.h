@@ -0,0 +1,55 @@
+#ifndef UPDATERATELOD_H
+#define UPDATERATELOD_H
+
+#include "ECS/ECS.h"
+#include "glm/glm.hpp"
+
+#include <SDL.h>
+#include <cstdint>
+#include <vector>
+
+// Tick rate level of detail for the systems that opt in. The entities far from the view
+// are updated every few frames only, each one on its own turn so the work of a frame is
+// spread over the buckets, and their step then covers all the time they waited.
+// Disabled by default, every entity is then stepped every frame.
+class UpdateRateLod {
+public:
+    // Entities farther than `distance` world units from the view update every `period` frames
+    struct Tier {
+        float distance;
+        int period;
+    };
+
+    UpdateRateLod();
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const { return enabled; }
+
+    // Sorted by distance
+    void SetTiers(std::vector<Tier> tiers);
+    void SetView(const SDL_Rect& view);
+
+    // Starts a frame of the owning system
+    void BeginFrame(double deltaTime);
+
+    // False while the entity waits for its turn. Otherwise `elapsed` is the time to simulate,
+    // the frames it waited included.
+    bool Step(Entity entity, glm::vec2 position, double& elapsed);
+
+    // The next step of the entity only covers its own frame, e.g. after it was asleep or reused
+    void Reset(Entity entity);
+
+private:
+    bool enabled = false;
+    std::vector<Tier> tiers;
+    SDL_Rect view = { 0, 0, 0, 0 };
+
+    std::uint32_t frame = 0;
+    double clock = 0.0;
+    double deltaTime = 0.0;
+    std::vector<double> lastSteps;  // [ entity id ] clock at the last step, negative when unknown
+
+    int GetPeriod(glm::vec2 position) const;
+};
+
+#endif  // UPDATERATELOD_H
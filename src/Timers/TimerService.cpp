@@ -0,0 +1,148 @@
+#include "TimerService.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Delays past the last level are parked in it and moved down until they are due
+    constexpr double MAX_DELAY_TICKS = 4.0e18;
+}  // namespace
+
+TimerService::TimerService(double tickSeconds) : tickSeconds(tickSeconds > 0.0 ? tickSeconds : 0.001) {
+    slotHeads.fill(NONE);
+}
+
+bool TimerService::Cancel(TimerId timer) {
+    if (!IsPending(timer))
+        return false;
+
+    const auto index = static_cast<std::uint32_t>(timer & 0xFFFFFFFFu);
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+bool TimerService::IsPending(TimerId timer) const {
+    const auto index = static_cast<std::uint32_t>(timer & 0xFFFFFFFFu);
+    const auto generation = static_cast<std::uint32_t>(timer >> 32);
+    return index < timers.size() && timers[index].generation == generation && timers[index].slot != NONE;
+}
+
+void TimerService::Update(double deltaTime, EventBus& eventBus) {
+    accumulator += deltaTime;
+    const double ticks = std::floor(accumulator / tickSeconds);
+    if (ticks < 1.0)
+        return;
+    accumulator -= ticks * tickSeconds;
+
+    const auto count = static_cast<std::uint64_t>(ticks);
+    for (std::uint64_t i = 0; i < count; i++) {
+        // Nothing to expire or to move, the clock can jump
+        if (pendingCount == 0) {
+            currentTick += count - i;
+            break;
+        }
+        Tick(eventBus);
+    }
+}
+
+TimerId TimerService::Add(double delaySeconds, PublishFunction publish, const void* event, std::size_t size) {
+    std::uint32_t index;
+    if (!freeTimers.empty()) {
+        index = freeTimers.back();
+        freeTimers.pop_back();
+    } else {
+        index = static_cast<std::uint32_t>(timers.size());
+        timers.emplace_back();
+    }
+
+    // Due on the next tick at the earliest, the current one is already done
+    const double ticks = std::min(std::ceil(delaySeconds / tickSeconds), MAX_DELAY_TICKS);
+    Timer& timer = timers[index];
+    timer.generation++;
+    timer.expiry = currentTick + (ticks >= 1.0 ? static_cast<std::uint64_t>(ticks) : 1);
+    timer.publish = publish;
+    std::memcpy(timer.event, event, size);
+
+    Link(index);
+    pendingCount++;
+    return (static_cast<TimerId>(timer.generation) << 32) | index;
+}
+
+void TimerService::Link(std::uint32_t index) {
+    Timer& timer = timers[index];
+    const std::uint64_t delta = timer.expiry > currentTick ? timer.expiry - currentTick : 0;
+
+    // The finest level whose span covers the delay
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (std::uint64_t(1) << (SLOT_BITS * (level + 1))))
+        level++;
+
+    std::uint64_t slotTick = timer.expiry;
+    if (delta >= (std::uint64_t(1) << (SLOT_BITS * LEVELS)))
+        slotTick = currentTick + (std::uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+
+    const auto slot =
+        static_cast<std::uint32_t>(level * SLOTS + ((slotTick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+    timer.slot = slot;
+    timer.previous = NONE;
+    timer.next = slotHeads[slot];
+    if (timer.next != NONE)
+        timers[timer.next].previous = index;
+    slotHeads[slot] = index;
+}
+
+void TimerService::Unlink(std::uint32_t index) {
+    Timer& timer = timers[index];
+    if (timer.previous != NONE)
+        timers[timer.previous].next = timer.next;
+    else
+        slotHeads[timer.slot] = timer.next;
+    if (timer.next != NONE)
+        timers[timer.next].previous = timer.previous;
+    timer.slot = NONE;
+}
+
+void TimerService::Release(std::uint32_t index) {
+    timers[index].slot = NONE;
+    freeTimers.push_back(index);
+    pendingCount--;
+}
+
+void TimerService::Cascade(int level) {
+    const auto slot = static_cast<std::uint32_t>(
+        level * SLOTS + ((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+
+    // Every timer of the slot is due within this level's span, it goes down a level or more
+    std::uint32_t index = slotHeads[slot];
+    slotHeads[slot] = NONE;
+    while (index != NONE) {
+        const std::uint32_t next = timers[index].next;
+        Link(index);
+        index = next;
+    }
+}
+
+void TimerService::Tick(EventBus& eventBus) {
+    currentTick++;
+
+    // A level moves down when all the levels below it wrapped around
+    for (int level = 1; level < LEVELS; level++) {
+        if ((currentTick & ((std::uint64_t(1) << (SLOT_BITS * level)) - 1)) != 0)
+            break;
+        Cascade(level);
+    }
+
+    // The whole slot expires at once
+    const auto slot = static_cast<std::uint32_t>(currentTick & (SLOTS - 1));
+    expired.clear();
+    for (std::uint32_t index = slotHeads[slot]; index != NONE; index = timers[index].next)
+        expired.push_back(index);
+    slotHeads[slot] = NONE;
+
+    for (const std::uint32_t index : expired) {
+        const Timer& timer = timers[index];
+        timer.publish(eventBus, timer.event);
+        Release(index);
+    }
+}
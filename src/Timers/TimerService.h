@@ -0,0 +1,96 @@
+#ifndef TIMERSERVICE_H
+#define TIMERSERVICE_H
+
+#include "EventBus/EventBus.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// 0 is never a timer
+using TimerId = std::uint64_t;
+
+// "Publish this event in T seconds". The timers sit in a hierarchical timing wheel: 4 levels
+// of 256 slots, each level a 256 times coarser tick than the one below. Scheduling and
+// cancelling only link or unlink a timer in a slot, a tick expires the whole slot at once
+// and the timers of the coarser levels move down a level when their slot comes up.
+class TimerService {
+public:
+    // Small events are stored in the timer itself
+    static constexpr std::size_t MAX_EVENT_SIZE = 32;
+
+    explicit TimerService(double tickSeconds = 0.001);
+
+    template <typename TEvent>
+    TimerId Schedule(double delaySeconds, const TEvent& event);
+
+    // False when the timer already expired or was cancelled
+    bool Cancel(TimerId timer);
+    bool IsPending(TimerId timer) const;
+    std::size_t GetPendingCount() const { return pendingCount; }
+
+    // Seconds on the clock of the timers. Setting it only changes the reading, the pending
+    // timers keep their delays, e.g. to go back to the time of a snapshot.
+    double GetTime() const { return static_cast<double>(currentTick) * tickSeconds + accumulator + timeOffset; }
+    void SetTime(double time) { timeOffset += time - GetTime(); }
+
+    // Advances the clock and publishes the events of the expired timers, in expiry order
+    void Update(double deltaTime, EventBus& eventBus);
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu;
+
+    using PublishFunction = void (*)(EventBus& eventBus, const void* event);
+
+    struct Timer {
+        std::uint64_t expiry;  // tick
+        std::uint32_t previous;  // in the slot list
+        std::uint32_t next;
+        std::uint32_t slot;  // NONE when not pending
+        std::uint32_t generation;
+        PublishFunction publish;
+        alignas(std::max_align_t) std::byte event[MAX_EVENT_SIZE];
+    };
+
+    double tickSeconds;
+    double accumulator = 0.0;
+    std::uint64_t currentTick = 0;
+    double timeOffset = 0.0;
+
+    std::vector<Timer> timers;
+    std::vector<std::uint32_t> freeTimers;
+    std::array<std::uint32_t, LEVELS * SLOTS> slotHeads;  // [ level * SLOTS + slot ]
+    std::size_t pendingCount = 0;
+
+    // Reused by every tick
+    std::vector<std::uint32_t> expired;
+
+    TimerId Add(double delaySeconds, PublishFunction publish, const void* event, std::size_t size);
+    void Link(std::uint32_t index);
+    void Unlink(std::uint32_t index);
+    void Release(std::uint32_t index);
+    void Cascade(int level);
+    void Tick(EventBus& eventBus);
+
+    template <typename TEvent>
+    static void PublishEvent(EventBus& eventBus, const void* event) {
+        eventBus.Publish(static_cast<const TEvent*>(event), 1);
+    }
+};
+
+template <typename TEvent>
+TimerId TimerService::Schedule(double delaySeconds, const TEvent& event) {
+    static_assert(std::is_trivially_copyable<TEvent>::value, "Events are copied as bytes");
+    static_assert(sizeof(TEvent) <= MAX_EVENT_SIZE, "Timer events are limited to MAX_EVENT_SIZE bytes");
+    static_assert(alignof(TEvent) <= alignof(std::max_align_t), "Over aligned timer event");
+
+    return Add(delaySeconds, &PublishEvent<TEvent>, &event, sizeof(TEvent));
+}
+
+#endif  // TIMERSERVICE_H